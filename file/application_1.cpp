@@ -1,42 +1,42 @@
 #include "executive.h"
-#include <iostream>
+#include "rt_log.h"
 
 #include "busy_wait.h"
 
 void task0()
 {
-	std::cout << "Sono il task n.0" << std::endl;
+	rtlog::info("Sono il task n.0");
 	busy_wait(90);
 }
 
 void task1()
 {
-	std::cout << "Sono il task n.1" << std::endl;
+	rtlog::info("Sono il task n.1");
 	busy_wait(185);
 }
 void task2()
 {
-	std::cout << "Sono il task n.2" << std::endl;
+	rtlog::info("Sono il task n.2");
 	busy_wait(88);
 }
 
 void task3()
 {
-	std::cout << "Sono il task n.3" << std::endl;
+	rtlog::info("Sono il task n.3");
 	busy_wait(270);
 }
 
 void task4()
 {
-	std::cout << "Sono il task n.4" << std::endl;
+	rtlog::info("Sono il task n.4");
 	busy_wait(80);
 }
 
 /* void task_ap()
 {
-	std::cout << "Il task AP viene rilasciato" << std::endl;
+	rtlog::info("Il task AP viene rilasciato");
 	busy_wait(42);
-	std::cout << "Il task AP ha terminato" << std::endl;
+	rtlog::info("Il task AP ha terminato");
 } */
 
 
@@ -1,28 +1,28 @@
 #include "executive.h"
-#include <iostream>
+#include "rt_log.h"
 
 #include "busy_wait.h"
 
 void task0()
 {
-	std::cout << "Sono il task n.0" << std::endl;
+	rtlog::info("Sono il task n.0");
 	busy_wait(15);
 }
 
 void task1()
 {
-	std::cout << "Sono il task n.1" << std::endl;
+	rtlog::info("Sono il task n.1");
 	busy_wait(6);
 }
 void task2()
 {
-	std::cout << "Sono il task n.2" << std::endl;
+	rtlog::info("Sono il task n.2");
 	busy_wait(18);
 }
 
 void task3()
 {
-	std::cout << "Sono il task n.3" << std::endl;
+	rtlog::info("Sono il task n.3");
 	busy_wait(17);
 }
 
@@ -30,7 +30,7 @@ void task4()
 {
 	static unsigned count = 0;
 
-	std::cout << "Sono il task n.4" << std::endl;
+	rtlog::info("Sono il task n.4");
 	
 	if (++count % 5 == 0)
 		busy_wait(31);
@@ -40,7 +40,7 @@ void task4()
 
 void task5()
 {
-	std::cout << "Sono il task n.5" << std::endl;
+	rtlog::info("Sono il task n.5");
 	busy_wait(8);
 }
 
@@ -1,28 +1,28 @@
 #include "executive.h"
-#include <iostream>
+#include "rt_log.h"
 
 #include "busy_wait.h"
 
 void task0()
 {
-	std::cout << "Sono il task n.0" << std::endl;
+	rtlog::info("Sono il task n.0");
 	busy_wait(15);
 }
 
 void task1()
 {
-	std::cout << "Sono il task n.1" << std::endl;
+	rtlog::info("Sono il task n.1");
 	busy_wait(6);
 }
 void task2()
 {
-	std::cout << "Sono il task n.2" << std::endl;
+	rtlog::info("Sono il task n.2");
 	busy_wait(18);
 }
 
 void task3()
 {
-	std::cout << "Sono il task n.3" << std::endl;
+	rtlog::info("Sono il task n.3");
 	busy_wait(17);
 }
 
@@ -30,12 +30,13 @@ void task4(Executive & e)
 {
 	static unsigned count = 0;
 
-	std::cout << "Sono il task n.4" << std::endl;
+	rtlog::info("Sono il task n.4");
 	
 	if (++count % 5 == 0)
 	{
 		busy_wait(5);
-		e.ap_task_request();
+		if (!e.ap_task_request())
+			rtlog::info("Richiesta AP rifiutata");
 		busy_wait(7);
 	}
 	else
@@ -44,15 +45,15 @@ void task4(Executive & e)
 
 void task5()
 {
-	std::cout << "Sono il task n.5" << std::endl;
+	rtlog::info("Sono il task n.5");
 	busy_wait(8);
 }
 
 void task_ap()
 {
-	std::cout << "Il task AP viene rilasciato" << std::endl;
+	rtlog::info("Il task AP viene rilasciato");
 	busy_wait(10);
-	std::cout << "Il task AP ha terminato" << std::endl;
+	rtlog::info("Il task AP ha terminato");
 }
 
 int main()
@@ -68,7 +69,8 @@ int main()
 	exec.set_periodic_task(4, std::bind(task4, std::ref(exec)), 3);
 	exec.set_periodic_task(5, task5, 1);
 	
-	exec.set_aperiodic_task(task_ap, 5);
+	// wcet 5 non sta nello slack di un solo frame: deadline di 12 frame (richieste rifiutate oltre lo slack)
+	exec.add_aperiodic_task(task_ap, 5, 12);
 	
 	exec.add_frame({0,1,2});
 	exec.add_frame({3,4});
@@ -76,6 +78,9 @@ int main()
 	exec.add_frame({1,4,5});
 	exec.add_frame({0,2});
 	exec.add_frame({1,5,2});
+
+	// memoria bloccata in RAM prima del primo frame (nessun job di warm-up: task4 invia richieste AP)
+	exec.set_warmup(64 * 1024, 0, true);
 	
 	exec.start();
 	exec.wait();
@@ -0,0 +1,39 @@
+#include "executive.h"
+#include "schedule.h"
+#include "rt_log.h"
+#include <iostream>
+
+#include "busy_wait.h"
+
+/* Stesso task set di application_1, ma la tabella dei frame (e la suddivisione di tau_3 in slice)
+   viene calcolata da synthesize_schedule() invece che scritta a mano. */
+
+const unsigned int unit_duration = 100;
+
+int main()
+{
+	busy_wait_init();
+
+	frame_schedule sched = synthesize_schedule({
+		{4, 1, 4},    // tau_1 = (T, C, D)
+		{5, 2, 7},    // tau_2
+		{20, 5, 20}   // tau_3
+	});
+
+	std::cout << "H = " << sched.hyperperiod << ", m = " << sched.frame_length
+	          << ", " << sched.slices.size() << " slice" << std::endl;
+
+	Executive exec(sched.slices.size(), sched.frame_length, unit_duration);
+
+	sched.apply(exec, [](const slice & s) -> std::function<void()> {
+		return [s]() {
+			rtlog::info("Sono il task n.{}, slice {}", s.task, s.index);
+			busy_wait(s.wcet * unit_duration * 9 / 10);
+		};
+	});
+
+	exec.start();
+	exec.wait();
+
+	return 0;
+}
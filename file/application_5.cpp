@@ -0,0 +1,58 @@
+
+#include "executive.h"
+#include <iostream>
+#include <random>
+
+/* Simulazione in tempo virtuale dello schedule di application_3: i job durano tra il 50% e il 100%
+   del wcet (task 4 a volte sfora), il task aperiodico viene richiesto in media ogni 15 quanti.
+   Migliaia di iperperiodi richiedono pochi millisecondi invece di ore. */
+
+const unsigned int hyperperiods = 10000;
+
+int main()
+{
+	const unsigned int wcet[] = {2, 1, 2, 2, 3, 1};
+	std::mt19937 gen(42);
+
+	Executive exec(6, 5);
+
+	for (size_t id = 0; id < 6; ++id)
+	{
+		exec.set_periodic_task(id, [](){}, wcet[id]);
+		exec.set_sim_exec_time(id, [&gen, &wcet, id]() {
+			return std::uniform_real_distribution<double>(0.5, 1.0)(gen) * wcet[id];
+		});
+	}
+	// un job su 50 del task 4 dura il doppio del wcet
+	exec.set_sim_exec_time(4, [&gen]() { return std::bernoulli_distribution(0.02)(gen) ? 6.0 : 2.5; });
+
+	exec.add_aperiodic_task([](){}, 5, 12);
+	exec.set_sim_ap_arrivals(0, [&gen]() { return std::exponential_distribution<double>(1.0 / 15)(gen); });
+
+	exec.add_frame({0,1,2});
+	exec.add_frame({3,4});
+	exec.add_frame({0,3});
+	exec.add_frame({1,4,5});
+	exec.add_frame({0,2});
+	exec.add_frame({1,5,2});
+
+	auto begin = std::chrono::steady_clock::now();
+	exec.simulate(hyperperiods * 6);
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+
+	std::cout << hyperperiods << " iperperiodi simulati in " << elapsed.count() << " ms" << std::endl;
+	for (size_t id = 0; id < 6; ++id)
+	{
+		auto stats = exec.get_task_stats(id);
+		std::cout << "Task " << id << ": " << stats.response_time.count << " job, " << stats.misses << " deadline miss, "
+		          << "risposta p50 " << stats.response_time.percentile(0.5) / 1e6 << " ms, max "
+		          << stats.response_time.max / 1e6 << " ms" << std::endl;
+	}
+
+	auto ap = exec.get_ap_task_stats();
+	std::cout << "Task AP: " << ap.accepted << " richieste accettate, " << ap.rejected << " rifiutate, "
+	          << ap.misses << " deadline miss, latenza p50 " << ap.response_time.percentile(0.5) / 1e6
+	          << " ms, p99 " << ap.response_time.percentile(0.99) / 1e6 << " ms" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,61 @@
+#include "static_schedule.h"
+#include "rt_log.h"
+
+#include "busy_wait.h"
+
+/* Lo schedule di application_1 descritto a tempo di compilazione: un id di task sbagliato o un frame
+   con troppi quanti (es. static_frame<0,1,3>) non compila. */
+
+void task0()
+{
+	rtlog::info("Sono il task n.0");
+	busy_wait(90);
+}
+
+void task1()
+{
+	rtlog::info("Sono il task n.1");
+	busy_wait(185);
+}
+
+void task2()
+{
+	rtlog::info("Sono il task n.2");
+	busy_wait(88);
+}
+
+void task3()
+{
+	rtlog::info("Sono il task n.3");
+	busy_wait(270);
+}
+
+void task4()
+{
+	rtlog::info("Sono il task n.4");
+	busy_wait(80);
+}
+
+typedef static_schedule<4,
+                        static_tasks< static_task<task0, 1>,    // tau_1
+                                      static_task<task1, 2>,    // tau_2
+                                      static_task<task2, 1>,    // tau_3,1
+                                      static_task<task3, 3>,    // tau_3,2
+                                      static_task<task4, 1> >,  // tau_3,3
+                        static_frame<0,1,2>,
+                        static_frame<0,3>,
+                        static_frame<0,1>,
+                        static_frame<0,1>,
+                        static_frame<0,1,4> > schedule;
+
+int main()
+{
+	busy_wait_init();
+
+	StaticExecutive<schedule> exec(400);
+
+	exec.start();
+	exec.wait();
+
+	return 0;
+}
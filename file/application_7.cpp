@@ -0,0 +1,68 @@
+#include "executive.h"
+#include "schedule_file.h"
+#include "rt_log.h"
+#include <iostream>
+
+#include "busy_wait.h"
+
+/* I task di application_1, con frame, wcet e durata del quanto letti da file:
+	application_7 [schedule]    (default schedules/application_1.bin, prodotto da make)
+   Lo schedule può essere testuale o binario; le funzioni vengono associate ai task per nome. */
+
+void task0()
+{
+	rtlog::info("Sono il task n.0");
+	busy_wait(90);
+}
+
+void task1()
+{
+	rtlog::info("Sono il task n.1");
+	busy_wait(185);
+}
+
+void task2()
+{
+	rtlog::info("Sono il task n.2");
+	busy_wait(88);
+}
+
+void task3()
+{
+	rtlog::info("Sono il task n.3");
+	busy_wait(270);
+}
+
+void task4()
+{
+	rtlog::info("Sono il task n.4");
+	busy_wait(80);
+}
+
+int main(int argc, char ** argv)
+{
+	const char * path = argc > 1 ? argv[1] : "schedules/application_1.bin";
+
+	busy_wait_init();
+
+	try {
+		schedule_file sched(path);
+
+		Executive exec(sched.num_tasks(), sched.frame_length(), sched.unit_duration());
+		sched.apply(exec, {
+			{"task0", task0},
+			{"task1", task1},
+			{"task2", task2},
+			{"task3", task3},
+			{"task4", task4}
+		});
+
+		exec.start();
+		exec.wait();
+	} catch (const schedule_error & e) {
+		std::cerr << "[ERROR] " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include "executive.h"
+#include "rt_log.h"
+
+#include "busy_wait.h"
+
+#include <chrono>
+#include <thread>
+
+void task0()
+{
+	rtlog::info("Sono il task n.0");
+	busy_wait(90);
+}
+
+void task1()
+{
+	rtlog::info("Sono il task n.1");
+	busy_wait(185);
+}
+
+void task2()
+{
+	rtlog::info("Sono il task n.2");
+	busy_wait(88);
+}
+
+void task3()
+{
+	rtlog::info("Sono il task n.3");
+	busy_wait(270);
+}
+
+void task4()
+{
+	rtlog::info("Sono il task n.4");
+	busy_wait(80);
+}
+
+/* Lo schedule di application_1 come modalità "default" e una modalità "ridotta" che esegue solo
+   tau_1 e tau_3,2 (iperperiodo di 2 frame): si passa da una all'altra durante l'esecuzione */
+int main()
+{
+	busy_wait_init();
+
+	Executive exec(5, 4, 400);
+
+	exec.set_periodic_task(0, task0, 1); // tau_1
+	exec.set_periodic_task(1, task1, 2); // tau_2
+	exec.set_periodic_task(2, task2, 1); // tau_3,1
+	exec.set_periodic_task(3, task3, 3); // tau_3,2
+	exec.set_periodic_task(4, task4, 1); // tau_3,3
+
+	exec.add_frame({0,1,2});
+	exec.add_frame({0,3});
+	exec.add_frame({0,1});
+	exec.add_frame({0,1});
+	exec.add_frame({0,1,4});
+
+	exec.add_mode("ridotta", {{0}, {0,3}});
+
+	exec.start();
+
+	for (const char * mode : {"ridotta", "default"})
+	{
+		std::this_thread::sleep_for(std::chrono::seconds(7));
+		if (!exec.request_mode(mode))
+			rtlog::warn("[WARN] Cambio di modalità rifiutato");
+	}
+
+	std::this_thread::sleep_for(std::chrono::seconds(10));
+	histogram_snapshot latency = exec.get_mode_switch_latency();
+	rtlog::info("Modalità {}: {} cambi, latenza massima {} ms", exec.get_mode().c_str(), latency.count, latency.max / 1000000);
+
+	// fine dell'esecuzione: i thread dei task terminano e wait() restituisce il riepilogo
+	exec.stop();
+	exec.wait();
+
+	return 0;
+}
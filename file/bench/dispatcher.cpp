@@ -0,0 +1,111 @@
+/* Costo dell'executive al crescere del numero di task.
+   Per ogni dimensione (6, 64, 512, 4096 task) e per ogni scheduling dei task (scala di priorità SCHED_FIFO,
+   SCHED_DEADLINE con il budget diviso tra i task nell'80% del frame, oppure esecuzione inline nel thread
+   dell'executive, senza thread per i task) un Executive esegue num_frames frame
+   (run_for) su un core con tutti i task rilasciati in ogni frame (corpo vuoto, wcet 0) e misura:
+	- release latency: inizio nominale del frame -> avvio del task (comprende il ritardo del confine
+	  e l'attesa dietro ai task rilasciati prima);
+	- frame jitter: ritardo dell'executive rispetto al confine nominale del frame;
+	- dispatcher cpu: tempo di CPU dell'executive per frame;
+	- context switch per frame (volontari + involontari, di tutto il processo).
+   Output: una riga JSON per (dimensione, scheduling).
+   L'executive è compilato con RTLOG_LEVEL=2 (senza traccia dei frame e senza riepilogo), l'output resta solo JSON.
+*/
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "../executive.h"
+#include "../rt/priority.h"
+
+static const unsigned int num_frames = 100;
+static const unsigned int table_frames = 4;
+
+static void merge(histogram_snapshot & into, const histogram_snapshot & h)
+{
+	if (into.buckets.empty())
+		into.buckets.assign(h.buckets.size(), 0);
+	into.count += h.count;
+	into.sum += h.sum;
+	into.max = std::max(into.max, h.max);
+	for (size_t b = 0; b < h.buckets.size(); ++b)
+		into.buckets[b] += h.buckets[b];
+}
+
+static long context_switches()
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+static void print_hist(const char * name, const histogram_snapshot & h)
+{
+	std::printf("\"%s\":{\"p50\":%llu,\"p99\":%llu,\"max\":%llu}", name,
+	            static_cast<unsigned long long>(h.percentile(0.5)),
+	            static_cast<unsigned long long>(h.percentile(0.99)),
+	            static_cast<unsigned long long>(h.max));
+}
+
+enum sched { fifo, deadline, inline_dispatch };
+static const char * const sched_names[] = { "fifo", "deadline", "inline" };
+
+static void run(size_t num_tasks, sched mode)
+{
+	// frame (in ms) abbastanza lungo da rilasciare ed eseguire tutti i task
+	const unsigned int frame_ms = 2 + num_tasks / 100;
+
+	Executive exec(num_tasks, frame_ms, 1);
+	exec.set_deadline_scheduling(mode == deadline, std::chrono::microseconds(frame_ms * 800 / num_tasks));
+	exec.set_inline_dispatch(mode == inline_dispatch);
+	std::vector<size_t> frame(num_tasks);
+	for (size_t id = 0; id < num_tasks; ++id)
+	{
+		exec.set_periodic_task(id, [](){}, 0);
+		frame[id] = id;
+	}
+	for (unsigned int f = 0; f < table_frames; ++f)
+		exec.add_frame(frame);
+
+	bool rt = true;
+	try {
+		rt::this_thread::scoped_priority probe(rt::priority::rt_min);
+	} catch (const rt::permission_error &) {
+		rt = false;
+	}
+
+	const long switches = context_switches();
+	const Executive::run_summary summary = exec.run_for(num_frames);
+	const long frame_switches = context_switches() - switches;
+
+	histogram_snapshot release;
+	for (size_t id = 0; id < num_tasks; ++id)
+		merge(release, exec.get_task_stats(id).release_jitter);
+	const histogram_snapshot lateness = exec.get_frame_lateness();
+	const histogram_snapshot cpu = exec.get_dispatcher_cpu_time();
+
+	std::printf("{\"bench\":\"dispatcher\",\"sched\":\"%s\",\"tasks\":%zu,\"frame_ms\":%u,\"frames\":%llu,\"rt\":%s,",
+	            sched_names[mode], num_tasks, frame_ms, static_cast<unsigned long long>(summary.frames),
+	            rt ? "true" : "false");
+	print_hist("release_latency_ns", release);
+	std::printf(",");
+	print_hist("frame_jitter_ns", lateness);
+	std::printf(",");
+	print_hist("dispatcher_cpu_ns", cpu);
+	std::printf(",\"context_switches_per_frame\":%.1f,\"deadline_misses\":%llu,\"overruns\":%llu,\"teardown_us\":%lld}\n",
+	            summary.frames ? static_cast<double>(frame_switches) / summary.frames : 0.0,
+	            static_cast<unsigned long long>(summary.misses), static_cast<unsigned long long>(summary.overruns),
+	            static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(summary.drain_time).count()));
+	std::fflush(stdout);
+}
+
+int main()
+{
+	for (size_t n: {6, 64, 512, 4096})
+		for (sched mode: {fifo, deadline, inline_dispatch})
+			run(n, mode);
+
+	return 0;
+}
@@ -0,0 +1,199 @@
+/* Confronto del percorso di rilascio dei task:
+	- "cv":    mutex + due condition variable per task (vecchio task_data);
+	- "futex": parola di stato atomica + futex wait/wake (task_data attuale).
+   Per ogni frame l'executive (priorità rt_max) rilascia N task (priorità a scalare) sullo stesso core
+   e misura quanto impiega a rilasciarli tutti (frame-start) e dopo quanto parte l'ultimo task.
+   Output: una riga JSON per (meccanismo, numero di task).
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../rt/affinity.h"
+#include "../rt/priority.h"
+#include "../rt/futex.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+enum { IDLE, READY, RUNNING, DONE };
+
+struct cv_slot
+{
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::condition_variable cv_done;
+	int state = IDLE;
+	bool stop = false;
+	bench_clock::time_point start;
+
+	void release()
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		state = READY;
+		cv.notify_one();
+	}
+
+	bool wait_release()
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		cv.wait(lock, [this]() { return state == READY || stop; });
+		state = RUNNING;
+		return !stop;
+	}
+
+	void done()
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		state = DONE;
+		cv_done.notify_one();
+	}
+
+	bool is_done()
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		return state == DONE;
+	}
+
+	void shutdown()
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		stop = true;
+		cv.notify_one();
+	}
+};
+
+struct futex_slot
+{
+	std::atomic<int> state{IDLE};
+	std::atomic<bool> stop{false};
+	bench_clock::time_point start;
+
+	void release()
+	{
+		state.store(READY, std::memory_order_release);
+		rt::futex_wake(state);
+	}
+
+	bool wait_release()
+	{
+		while (true) {
+			int s = state.load(std::memory_order_acquire);
+			if (stop.load())
+				return false;
+			if (s == READY && state.compare_exchange_strong(s, RUNNING))
+				return true;
+			rt::futex_wait(state, s);
+		}
+	}
+
+	void done()
+	{
+		state.store(DONE, std::memory_order_release);
+	}
+
+	bool is_done()
+	{
+		return state.load(std::memory_order_acquire) == DONE;
+	}
+
+	void shutdown()
+	{
+		stop.store(true);
+		state.store(-1);
+		rt::futex_wake(state);
+	}
+};
+
+static long long percentile(std::vector<long long> v, double p)
+{
+	std::sort(v.begin(), v.end());
+	return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+}
+
+template <typename Slot>
+static void run(const char * name, size_t num_tasks, size_t num_frames)
+{
+	const rt::affinity core0 = rt::affinity::single(0);
+	std::vector<Slot> slots(num_tasks);
+	std::vector<std::thread> threads;
+
+	for (auto & slot: slots)
+	{
+		threads.push_back(std::thread([&slot]() {
+			while (slot.wait_release())
+			{
+				slot.start = bench_clock::now();
+				slot.done();
+			}
+		}));
+		rt::set_affinity(threads.back(), core0);
+	}
+
+	rt::this_thread::set_affinity(core0);
+	bool rt_ok = true;
+	try {
+		rt::this_thread::set_priority(rt::priority::rt_max);
+		auto prio = rt::priority::rt_max - 1;
+		for (auto & th: threads)
+			rt::set_priority(th, prio--);
+	} catch (const rt::permission_error &) {
+		rt_ok = false;
+	}
+
+	std::vector<long long> frame_start, last_start;
+	auto next = bench_clock::now();
+	for (size_t f = 0; f < num_frames; ++f)
+	{
+		next += std::chrono::milliseconds(2);
+		std::this_thread::sleep_until(next);
+
+		auto t0 = bench_clock::now();
+		for (auto & slot: slots)
+			slot.release();
+		auto t1 = bench_clock::now();
+
+		// l'executive non può attendere attivamente (FIFO, stesso core): dorme fino a fine frame
+		std::this_thread::sleep_until(next + std::chrono::milliseconds(1));
+		for (auto & slot: slots)
+			while (!slot.is_done())
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+
+		bench_clock::time_point last = t0;
+		for (auto & slot: slots)
+			last = std::max(last, slot.start);
+
+		frame_start.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+		last_start.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(last - t0).count());
+	}
+
+	rt::this_thread::set_priority(rt::priority::not_rt);
+	for (auto & slot: slots)
+		slot.shutdown();
+	for (auto & th: threads)
+		th.join();
+
+	std::printf("{\"bench\":\"release_latency\",\"mechanism\":\"%s\",\"tasks\":%zu,\"frames\":%zu,\"rt\":%s,"
+	            "\"frame_start_ns\":{\"p50\":%lld,\"p99\":%lld,\"max\":%lld},"
+	            "\"last_task_start_ns\":{\"p50\":%lld,\"p99\":%lld,\"max\":%lld}}\n",
+	            name, num_tasks, num_frames, rt_ok ? "true" : "false",
+	            percentile(frame_start, 0.5), percentile(frame_start, 0.99), percentile(frame_start, 1.0),
+	            percentile(last_start, 0.5), percentile(last_start, 0.99), percentile(last_start, 1.0));
+}
+
+int main()
+{
+	const size_t num_frames = 500;
+
+	for (size_t n: {1, 8, 64})
+	{
+		run<cv_slot>("cv", n, num_frames);
+		run<futex_slot>("futex", n, num_frames);
+	}
+
+	return 0;
+}
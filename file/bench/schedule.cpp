@@ -0,0 +1,73 @@
+/* Tempo di sintesi di synthesize_schedule() al crescere del numero di task.
+   Per ogni dimensione (100, 200, 400, 800 task) genera task set casuali con periodi in {1000, 2000, 4000,
+   5000, 10000} quanti (iperperiodo 20000, da 2 a 20 job per task) e utilizzazione circa 0.7, e misura
+   la durata della sintesi (mediana e massimo su num_sets task set).
+   Misura anche il rifiuto di un task set con un iperperiodo enorme ({2, 1}, {20000003, 1}): i limiti
+   vanno controllati prima di espandere i job.
+   Output: una riga JSON per dimensione, più una per il rifiuto.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../schedule.h"
+
+static const unsigned int num_sets = 20;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point since)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+static void run(size_t num_tasks, std::mt19937 & rng)
+{
+	static const unsigned int periods[] = {1000, 2000, 4000, 5000, 10000};
+	std::uniform_int_distribution<size_t> pick(0, 4);
+
+	std::vector<double> times;
+	size_t slices = 0, failed = 0;
+	for (unsigned int n = 0; n < num_sets; ++n)
+	{
+		std::vector<task_spec> tasks;
+		for (size_t i = 0; i < num_tasks; ++i)
+		{
+			const unsigned int period = periods[pick(rng)];
+			const unsigned int wcet = std::max(1u, static_cast<unsigned int>(0.7 * period / num_tasks));
+			tasks.push_back(task_spec{period, wcet, 0});
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		try {
+			slices += synthesize_schedule(tasks).slices.size();
+		}
+		catch (const schedule_error &) {
+			++failed;
+		}
+		times.push_back(elapsed_ms(start));
+	}
+
+	std::sort(times.begin(), times.end());
+	std::printf("{\"bench\":\"schedule\",\"tasks\":%zu,\"sets\":%u,\"failed\":%zu,\"slices_avg\":%zu,\"p50_ms\":%.3f,\"max_ms\":%.3f}\n",
+	            num_tasks, num_sets, failed, slices / num_sets, times[times.size() / 2], times.back());
+	std::fflush(stdout);
+}
+
+int main()
+{
+	std::mt19937 rng(1);
+	for (size_t n: {100, 200, 400, 800})
+		run(n, rng);
+
+	const auto start = std::chrono::steady_clock::now();
+	bool rejected = false;
+	try {
+		synthesize_schedule({{2, 1, 0}, {20000003, 1, 0}});
+	}
+	catch (const schedule_error &) {
+		rejected = true;
+	}
+	std::printf("{\"bench\":\"schedule_reject\",\"rejected\":%s,\"ms\":%.3f}\n", rejected ? "true" : "false", elapsed_ms(start));
+	return 0;
+}
@@ -1,42 +1,38 @@
 #include "busy_wait.h"
 
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
 
-// cycles until a maximum amount of milliseconds or a maximum amount of cycles espires
-static unsigned int busy_wait_impl(unsigned int max_millisec, unsigned int max_cycles)
+#include "rt/timer.h"
+
+void busy_wait_init()
 {
+	// a cpu-time clock needs no calibration: it only has to exist and advance
+	const auto t0 = rt::thread_cpu_time();
 	volatile unsigned int cycles = 0;
-
-	auto stop_time = std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(max_millisec);
-
-	while (cycles < max_cycles && std::chrono::high_resolution_clock::now() < stop_time)
+	while (rt::thread_cpu_time() == t0 && cycles < 100000000)
 		++cycles;
-		
-	return cycles;
-}
-
-// estimation: the number of busy_wait_impl() cycles that correspond to a millisec
-static unsigned int millisec_cycles = 0;
 
-// estimates millisec_cycles
-void busy_wait_init()
-{
-	unsigned int sum = 0;
-	unsigned int i;
-	
-	for (i=0; i<10; ++i)
+	if (rt::thread_cpu_time() == t0)
 	{
-		sum += busy_wait_impl(100, 0xFFFFFFFF);
+		std::fprintf(stderr, "[ERROR] busy_wait: il clock di cpu del thread non avanza (CLOCK_THREAD_CPUTIME_ID non disponibile)\n");
+		std::abort();
 	}
-	
-	millisec_cycles = sum / 10 / 100;
 }
 
-// does a busy wait pause
-void busy_wait(unsigned int millisec)
+void busy_wait_us(unsigned int microsec)
 {
-	busy_wait_impl(100000, millisec * millisec_cycles);
-}
-
+	const auto stop = rt::thread_cpu_time() + std::chrono::microseconds(microsec);
+	volatile unsigned int cycles = 0;
 
+	// short bursts of work between two clock reads keep the overhead of the clock low
+	while (rt::thread_cpu_time() < stop)
+		for (unsigned int i = 0; i < 64; ++i)
+			++cycles;
+}
 
+void busy_wait(unsigned int millisec)
+{
+	busy_wait_us(millisec * 1000);
+}
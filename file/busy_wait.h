@@ -1,10 +1,15 @@
 #ifndef BUSY_WAIT
 #define BUSY_WAIT
 
-// does "busy wait" calibration
+// checks that the thread cpu-time clock (rt::thread_cpu_time) advances, and aborts if it does not;
+// a cpu-time clock needs no calibration, so this returns immediately
 void busy_wait_init();
 
-// does a "busy wait", consuming the given amount of cpu time
+// does a "busy wait", consuming the given amount of cpu time of the calling thread
+// (time spent preempted does not count, so a preempted task still executes for "millisec")
 void busy_wait(unsigned int millisec);
 
-#endif
\ No newline at end of file
+// same, in microseconds
+void busy_wait_us(unsigned int microsec);
+
+#endif
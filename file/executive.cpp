@@ -1,19 +1,65 @@
+#include <algorithm>
 #include <cassert>
-#include <iostream>
-
-#define VERBOSE
+#include <cmath>
+#include <system_error>
 
 #include "executive.h"
+#include "rt_log.h"
+#include "rt_trace.h"
 #include "rt/affinity.h"
+#include "rt/topology.h"
 #include "rt/priority.h"
+#include "rt/futex.h"
+#include "rt/memory.h"
+#include "rt/timer.h"
+
+// task periodico servito dal thread corrente (per job_cancelled / degraded_mode)
+static thread_local const void * current_task = nullptr;
+
+static int64_t to_ns(std::chrono::steady_clock::time_point t)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+static int64_t now_ns()
+{
+	return to_ns(std::chrono::steady_clock::now());
+}
+
+// stato e richieste di cambio di modalità: (modalità << 48) | frame assoluto
+static const unsigned int mode_shift = 48;
+static const uint64_t mode_frame_mask = (uint64_t(1) << mode_shift) - 1;
+
+// attesa dei predecessori: (frame assoluto << 16) | arrivi; il task si rilascia quando gli arrivi valgono
+// precedence_armed (l'executive aggiunge precedence_armed - predecessori, ogni predecessore 1)
+static const unsigned int precedence_shift = 16;
+static const uint64_t precedence_mask = 0xFFFF;
+static const uint64_t precedence_armed = 0x8000;
+static const uint64_t precedence_cancelled = 0xFFFF;  // frame chiuso senza rilascio: arrivi ignorati
 
 /* ------------------------------------------------------------------ */
 /*  Costruttore / setup                                               */
 /* ------------------------------------------------------------------ */
 
-Executive::Executive(size_t num_tasks, unsigned int frame_length, unsigned int unit_duration)
-	: p_tasks(num_tasks), frame_length(frame_length), unit_time(unit_duration)
+Executive::Executive(size_t num_tasks, unsigned int frame_length, unsigned int unit_duration, unsigned int num_cores)
+	: p_tasks(num_tasks), cores(num_cores), modes(1), frame_length(frame_length), unit_time(unit_duration)
 {
+	assert(num_cores > 0 && num_cores <= rt::cpu_count());
+	for (size_t c = 0; c < num_cores; ++c)
+		cores[c].cpu = c;
+	modes[0].name = "default";
+	for (auto & cell: reserved_slack)
+		cell.store(0, std::memory_order_relaxed);
+}
+
+Executive::~Executive()
+{
+	// i thread dei task e degli executive usano l'oggetto: vanno fermati e raccolti prima di distruggerlo
+	if (running.load(std::memory_order_acquire))
+	{
+		stop();
+		wait();
+	}
 }
 
 void Executive::set_periodic_task(size_t task_id, std::function<void()> periodic_task, unsigned int wcet)
@@ -21,13 +67,121 @@ void Executive::set_periodic_task(size_t task_id, std::function<void()> periodic
 	assert(task_id < p_tasks.size());
 	p_tasks[task_id].function = periodic_task;
 	p_tasks[task_id].wcet = wcet;
+	p_tasks[task_id].thread_function = nullptr;
+	p_tasks[task_id].job = nullptr;
+}
+
+void Executive::set_miss_policy(size_t task_id, MissPolicy policy)
+{
+	assert(task_id < p_tasks.size());
+	p_tasks[task_id].miss_policy = policy;
+}
+
+// priorità dei task aperiodici finchè hanno slack: subito sotto l'executive, sopra tutti i periodici
+// (calcolata a run time: rt_max è una costante di un'altra unità di traduzione, non ancora
+// inizializzata durante l'inizializzazione statica di questa)
+rt::priority Executive::ap_priority()
+{
+	return rt::priority::rt_max - 1;
+}
+
+bool Executive::job_cancelled()
+{
+	const task_data * task = static_cast<const task_data *>(current_task);
+	return task && task->cancelled.load(std::memory_order_relaxed);
+}
+
+bool Executive::degraded_mode()
+{
+	const task_data * task = static_cast<const task_data *>(current_task);
+	return task && task->degraded.load(std::memory_order_relaxed);
 }
 
 void Executive::set_aperiodic_task(std::function<void()> aperiodic_task, unsigned int wcet)
 {
-	ap_task.function = aperiodic_task;
-	ap_task.wcet = wcet;
-	ap_task_set = true;
+	assert(ap_tasks.empty());
+	add_aperiodic_task(aperiodic_task, wcet);
+}
+
+size_t Executive::add_aperiodic_task(std::function<void()> aperiodic_task, unsigned int wcet, unsigned int deadline,
+                                     unsigned int min_interarrival, size_t queue_size)
+{
+	assert(deadline > 0 && deadline <= max_ap_deadline);
+
+	ap_tasks.push_back(std::unique_ptr<ap_task_data>(new ap_task_data(queue_size)));
+	ap_task_data & ap = *ap_tasks.back();
+	ap.id = ap_tasks.size() - 1;
+	ap.function = aperiodic_task;
+	ap.wcet = wcet;
+	ap.deadline = deadline;
+	ap.min_interarrival = min_interarrival;
+	return ap_tasks.size() - 1;
+}
+
+void Executive::set_frame_timer(rt::frame_timer::overrun_policy policy, std::chrono::microseconds spin)
+{
+	overrun_policy = policy;
+	timer_spin = spin;
+}
+
+void Executive::set_deadline_scheduling(bool enable, std::chrono::microseconds min_runtime)
+{
+	assert(!started);
+	use_deadline = enable;
+	deadline_min_runtime = std::max<std::chrono::nanoseconds>(min_runtime, rt::min_deadline_runtime);
+}
+
+void Executive::set_inline_dispatch(bool enable)
+{
+	assert(!started);
+	inline_dispatch = enable;
+}
+
+void Executive::set_warmup(size_t stack_bytes, unsigned int warmup_jobs, bool lock_memory)
+{
+	warmup_stack = stack_bytes;
+	this->warmup_jobs = warmup_jobs;
+	warmup_lock = lock_memory;
+}
+
+void Executive::set_trace(const std::string & path, size_t events_per_thread)
+{
+	trace_path = path;
+	trace_events = events_per_thread;
+}
+
+void Executive::set_perf_counters(bool enable)
+{
+	assert(!started);
+	perf_enabled = enable;
+}
+
+void Executive::set_wcet_profiling(bool enable, double margin)
+{
+	assert(!started && margin >= 1);
+	wcet_profiling = enable;
+	wcet_margin = margin;
+}
+
+void Executive::set_task_core(size_t task_id, unsigned int core)
+{
+	assert(task_id < p_tasks.size());
+	assert(core < cores.size());
+	p_tasks[task_id].core = core;
+}
+
+void Executive::set_core_placement(CorePlacement placement, const rt::affinity & cpus)
+{
+	assert(!started);
+	this->placement = placement;
+	placement_cpus = cpus;
+}
+
+void Executive::add_precedence(size_t before, size_t after)
+{
+	assert(!started);
+	assert(before < p_tasks.size() && after < p_tasks.size() && before != after);
+	p_tasks[before].successors.push_back(after);
 }
 
 void Executive::add_frame(std::vector<size_t> frame)
@@ -35,208 +189,1576 @@ void Executive::add_frame(std::vector<size_t> frame)
 	for (auto & id: frame)
 		assert(id < p_tasks.size());
 
-	frames.push_back(frame);
+	modes[0].frames.push_back(frame);
+}
+
+void Executive::add_mode(const std::string & name, std::vector< std::vector<size_t> > frames)
+{
+	assert(!started && !frames.empty());
+	for (auto & mode: modes)
+		assert(mode.name != name);
+	for (auto & frame: frames)
+		for (auto & id: frame)
+			assert(id < p_tasks.size());
+
+	modes.push_back(mode_data());
+	modes.back().name = name;
+	modes.back().frames = std::move(frames);
 }
 /* ------------------------------------------------------------------ */
 /*  Start / Wait                                                      */
 /* ------------------------------------------------------------------ */
+void Executive::place_cores()
+{
+	if (placement == CorePlacement::IDENTITY)
+		return;
+
+	rt::affinity allowed = placement_cpus.any() ? placement_cpus : rt::this_thread::get_affinity();
+	allowed &= rt::online_cpus();
+
+	// una CPU per core fisico: quelle con un fratello SMT già preso vengono escluse
+	rt::affinity physical;
+	for (size_t cpu = allowed.next(); cpu < allowed.size(); cpu = allowed.next(cpu + 1))
+		if ((rt::smt_siblings(cpu) & physical).none())
+			physical.set(cpu);
+
+	// primo dominio (cache L3, altrimenti nodo NUMA) con abbastanza core fisici
+	rt::affinity chosen;
+	for (size_t cpu = physical.next(); cpu < physical.size() && chosen.none(); cpu = physical.next(cpu + 1))
+	{
+		rt::affinity domain = rt::cache_domain(cpu, 3);
+		if (domain.count() == 1 && rt::numa_node_of(cpu) >= 0)
+			domain = rt::numa_nodes()[rt::numa_node_of(cpu)];
+		if ((domain & physical).count() >= cores.size())
+			chosen = domain & physical;
+	}
+	if (chosen.none())
+	{
+		chosen = physical.count() >= cores.size() ? physical : allowed;
+		rtlog::warn("[WARN] Nessun dominio di cache con {} core fisici: core dell'executive sulle CPU {}",
+		            cores.size(), chosen.to_string().c_str());
+	}
+	if (chosen.count() < cores.size())
+	{
+		rtlog::error("[ERROR] CPU disponibili insufficienti per {} core: il core i resta sulla CPU i", cores.size());
+		return;
+	}
+
+	size_t cpu = chosen.next();
+	for (auto & c: cores)
+	{
+		c.cpu = cpu;
+		cpu = chosen.next(cpu + 1);
+	}
+}
+
+void Executive::prepare()
+{
+	assert(!modes[0].frames.empty());
+	assert(!started);
+	started = true;
+	place_cores();
+
+	// i vincoli di precedenza non devono formare cicli (ordinamento topologico)
+	std::vector<unsigned int> in_degree(p_tasks.size(), 0);
+	std::vector<bool> constrained(p_tasks.size(), false);
+	for (size_t id = 0; id < p_tasks.size(); ++id)
+		for (auto next: p_tasks[id].successors)
+		{
+			++in_degree[next];
+			constrained[id] = constrained[next] = true;
+		}
+	std::vector<size_t> ready;
+	for (size_t id = 0; id < p_tasks.size(); ++id)
+		if (in_degree[id] == 0)
+			ready.push_back(id);
+	for (size_t done = 0; done < ready.size(); ++done)
+		for (auto next: p_tasks[ready[done]].successors)
+			if (--in_degree[next] == 0)
+				ready.push_back(next);
+	assert(ready.size() == p_tasks.size());
+
+	size_t max_tasks = 0;
+	std::vector<unsigned int> predecessors(p_tasks.size());
+	std::vector<size_t> seen(p_tasks.size(), SIZE_MAX);  // ultimo frame in cui compare il task (durante il conteggio)
+	size_t frame_key = 0;  // frame di tutte le modalità, in sequenza
+	for (auto & mode: modes)
+	{
+		const auto & frames = mode.frames;
+
+		// partizionamento: ogni core riceve, per ogni frame, i soli task a lui assegnati (stesso ordine), in una
+		// tabella piatta con le priorità di rilascio precalcolate: in ordine di tabella subito sotto l'executive e
+		// i task AP; oltre il fondo della scala i task restano a rt_min (a pari priorità partono in ordine di rilascio)
+		mode.cores.assign(cores.size(), core_table());
+		for (auto & c: mode.cores)
+			c.frame_begin.assign(1, 0);
+		for (size_t f = 0; f < frames.size(); ++f)
+		{
+			// predecessori di ogni task presenti nello stesso frame, su qualunque core
+			++frame_key;
+			for (auto id: frames[f])
+			{
+				assert(seen[id] != frame_key || !constrained[id]);  // una volta per frame
+				seen[id] = frame_key;
+				predecessors[id] = 0;
+			}
+			for (auto id: frames[f])
+				for (auto next: p_tasks[id].successors)
+					if (seen[next] == frame_key)
+					{
+						// con l'esecuzione inline l'ordine della tabella di un core deve già rispettare il vincolo
+						assert(!inline_dispatch || (p_tasks[next].core == p_tasks[id].core &&
+						       std::find(frames[f].begin(), frames[f].end(), next) >
+						       std::find(frames[f].begin(), frames[f].end(), id)));
+						++predecessors[next];
+					}
+
+			for (auto id: frames[f])
+			{
+				core_table & c = mode.cores[p_tasks[id].core];
+				const unsigned int position = c.tasks.size() - c.frame_begin[f];
+				c.priorities.push_back(std::max(ap_priority() - ap_tasks.size() - position, rt::priority::rt_min));
+				c.predecessors.push_back(inline_dispatch ? 0 : predecessors[id]);
+				c.tasks.push_back(id);
+			}
+			for (auto & c: mode.cores)
+				c.frame_begin.push_back(c.tasks.size());
+		}
+
+		// SCHED_DEADLINE: budget = wcet, deadline = fine della posizione nel frame, periodo = distanza minima
+		// (in frame, anche a cavallo dell'iperperiodo) tra due rilasci dello stesso task
+		if (use_deadline)
+		{
+			const std::chrono::nanoseconds unit = unit_time;
+			std::vector<size_t> first(p_tasks.size(), SIZE_MAX), last(p_tasks.size(), SIZE_MAX);
+			std::vector<size_t> gap(p_tasks.size(), frames.size());
+			for (size_t f = 0; f < frames.size(); ++f)
+				for (auto id: frames[f])
+				{
+					if (last[id] == SIZE_MAX)
+						first[id] = f;
+					else
+						gap[id] = std::min(gap[id], std::max<size_t>(f - last[id], 1));
+					last[id] = f;
+				}
+			for (size_t id = 0; id < p_tasks.size(); ++id)
+				if (last[id] != SIZE_MAX && last[id] != first[id])
+					gap[id] = std::min(gap[id], first[id] + frames.size() - last[id]);
+
+			for (auto & c: mode.cores)
+				for (size_t f = 0; f < frames.size(); ++f)
+				{
+					std::chrono::nanoseconds end(0);
+					for (size_t i = c.frame_begin[f]; i < c.frame_begin[f + 1]; ++i)
+					{
+						const size_t id = c.tasks[i];
+						rt::deadline_params dl;
+						end += p_tasks[id].wcet * unit;
+						dl.period = std::min<std::chrono::nanoseconds>(gap[id] * frame_length * unit, rt::max_deadline_period());
+						dl.deadline = std::min(std::max<std::chrono::nanoseconds>(end, deadline_min_runtime), dl.period);
+						dl.runtime = std::min(std::max<std::chrono::nanoseconds>(p_tasks[id].wcet * unit, deadline_min_runtime), dl.deadline);
+						c.deadlines.push_back(dl);
+					}
+				}
+		}
+
+		// verifica che il carico di ogni core stia nel frame e calcola lo slack di ogni frame
+		for (size_t c = 0; c < cores.size(); ++c)
+		{
+			core_table & table = mode.cores[c];
+			table.slack.assign(frames.size(), 0);
+			for (size_t f = 0; f < frames.size(); ++f)
+			{
+				unsigned int load = 0;
+				for (size_t i = table.frame_begin[f]; i < table.frame_begin[f + 1]; ++i)
+					load += p_tasks[table.tasks[i]].wcet;
+				if (load > frame_length)
+					rtlog::warn("[WARN] Modalità {}, core {}, frame {}: wcet totale {} > frame_length", mode.name.c_str(), c, f, load);
+				else
+					table.slack[f] = frame_length - load;
+				max_tasks = std::max(max_tasks, table.frame_begin[f + 1] - table.frame_begin[f]);
+			}
+		}
+	}
+
+	for (auto & c: cores)
+	{
+		c.woken.reserve(max_tasks);
+		c.demoted.reserve(max_tasks + ap_tasks.size());
+	}
+}
+
 void Executive::start()
 {
-	rt::affinity core0(1);
+	assert(!running);
+	// le tabelle si preparano al primo avvio, un nuovo start() (dopo wait()) le riusa
+	if (!started)
+		prepare();
+	run_base = totals();
+
+	// i messaggi di executive e task vengono scritti da un thread non real-time
+	rtlog::start();
+
+	const auto lock_begin = std::chrono::steady_clock::now();
+	if (warmup_lock)
+	{
+		// le pagine si bloccano quando vengono toccate: degli stack dei thread solo la parte pre-caricata
+		try {
+			rt::lock_memory(true);
+			startup.memory_locked = true;
+		}
+		catch (const rt::permission_error& e) {
+			rtlog::error("[ERROR] Impossibile bloccare la memoria: {}", e.what());
+		}
+	}
+
+	// traccia: prima del warm-up, così i thread allocano i loro ring
+	if (!trace_path.empty())
+	{
+		if (rttrace::start(trace_path.c_str()))
+		{
+			for (size_t id = 0; id < p_tasks.size(); ++id)
+			{
+				p_tasks[id].trace_id = id;
+				rttrace::record(rttrace::TASK_INFO, id, p_tasks[id].core);
+			}
+			for (auto & ap: ap_tasks)
+			{
+				ap->trace_id = ap->id | rttrace::ap_flag;
+				rttrace::record(rttrace::TASK_INFO, ap->trace_id, 0);
+			}
+		}
+		else
+			rtlog::error("[ERROR] Impossibile aprire il file della traccia {}", trace_path.c_str());
+	}
+
+	// contatori dei job: le statistiche si accumulano tra un'esecuzione e l'altra, i contatori li apre ogni thread
+	if (perf_enabled)
+	{
+		for (auto & task: p_tasks)
+			if (!task.perf)
+				task.perf.reset(new perf_record());
+		for (auto & ap: ap_tasks)
+			if (!ap->perf)
+				ap->perf.reset(new perf_record());
+		const rt::perf_counters probe;
+		rtlog::info("[PERF] Contatori dei job: cycles {}, instructions {}, llc_misses {}, context_switches {}",
+		            probe.available(rt::perf_counters::cycles) ? "sì" : "no",
+		            probe.available(rt::perf_counters::instructions) ? "sì" : "no",
+		            probe.available(rt::perf_counters::llc_misses) ? "sì" : "no",
+		            probe.available(rt::perf_counters::context_switches) ? "sì" : "no");
+	}
+
+	if (wcet_profiling)
+	{
+		for (auto & task: p_tasks)
+			if (!task.exec_time)
+				task.exec_time.reset(new latency_histogram());
+		for (auto & ap: ap_tasks)
+			if (!ap->exec_time)
+				ap->exec_time.reset(new latency_histogram());
+	}
+
+	// i thread dei task fanno il warm-up appena creati, start() attende che abbiano finito tutti
+	const auto warmup_begin = std::chrono::steady_clock::now();
+	warming.store((inline_dispatch ? 0 : p_tasks.size()) + ap_tasks.size(), std::memory_order_relaxed);
 	for (size_t id = 0; id < p_tasks.size(); ++id)
 	{
 		assert(p_tasks[id].function);
-		p_tasks[id].thread = std::thread(&Executive::task_function, std::ref(p_tasks[id]));
-		rt::set_affinity(p_tasks[id].thread, core0);
+		if (inline_dispatch)
+		{
+			// nessun thread: i job di warm-up girano qui, lo stack dell'executive lo prepara exec_function
+			current_task = &p_tasks[id];
+			for (unsigned int i = 0; i < warmup_jobs; ++i)
+				(p_tasks[id].job ? p_tasks[id].job : &function_job::run)(p_tasks[id]);
+			current_task = nullptr;
+			continue;
+		}
+		auto thread_function = p_tasks[id].thread_function ? p_tasks[id].thread_function : &Executive::task_function<function_job>;
+		p_tasks[id].thread = std::thread(thread_function, this, std::ref(p_tasks[id]));
+		p_tasks[id].thread_prio.bind(p_tasks[id].thread);
+		rt::set_affinity(p_tasks[id].thread, rt::affinity::single(cores[p_tasks[id].core].cpu));
 	}
 
-	if (ap_task_set) {
-		ap_task.thread = std::thread(&Executive::task_function, std::ref(ap_task));
-		rt::set_affinity(ap_task.thread, core0);
+	// i task aperiodici girano sul core 0, nello slack della sua tabella
+	for (auto & ap: ap_tasks) {
+		ap->thread = std::thread(&Executive::ap_task_function, this, std::ref(*ap));
+		ap->thread_prio.bind(ap->thread);
+		rt::set_affinity(ap->thread, rt::affinity::single(cores[0].cpu));
 	}
+	ap_active.reserve(ap_tasks.size());
 
-	exec_thread = std::thread(&Executive::exec_function, this);
-	rt::set_affinity(exec_thread, core0);
-	//aggiunto assegnazione massima di priorità all' executive
-	try {
-    	rt::set_priority(exec_thread, rt::priority::rt_max);
-		}	 
-	catch (const rt::permission_error& e) {
-    	std::cerr << "[ERROR] Impossibile impostare la priorità dell'executive: " << e.what() << std::endl;
+	for (int left; (left = warming.load(std::memory_order_acquire)) > 0; )
+		rt::futex_wait(warming, left);
+	const auto warmup_end = std::chrono::steady_clock::now();
+
+	// istante di inizio comune, allineato alla durata del frame: i confini dei frame coincidono su tutti i core
+	const std::chrono::nanoseconds frame = frame_length * unit_time;
+	const auto earliest = (warmup_end + unit_time).time_since_epoch();
+	start_time = std::chrono::steady_clock::time_point(
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>(frame * ((earliest + frame - std::chrono::nanoseconds(1)) / frame)));
+
+	startup.lock_time = warmup_begin - lock_begin;
+	startup.warmup_time = warmup_end - warmup_begin;
+	startup.start_delay = start_time - warmup_end;
+	rtlog::info("[STARTUP] memoria {} ({} us), warm-up dei task: {} us, frame 0 tra {} us",
+	            startup.memory_locked ? "bloccata" : "non bloccata",
+	            std::chrono::duration_cast<std::chrono::microseconds>(startup.lock_time).count(),
+	            std::chrono::duration_cast<std::chrono::microseconds>(startup.warmup_time).count(),
+	            std::chrono::duration_cast<std::chrono::microseconds>(startup.start_delay).count());
+	for (auto & c: cores)
+		c.timer.reset(new rt::frame_timer(start_time, frame_length * unit_time, overrun_policy, modes[0].frames.size(), timer_spin));
+	running.store(true, std::memory_order_release);
+
+	for (size_t c = 0; c < cores.size(); ++c)
+	{
+		cores[c].exec_thread = std::thread(&Executive::exec_function, this, c);
+		rt::set_affinity(cores[c].exec_thread, rt::affinity::single(cores[c].cpu));
+		//aggiunto assegnazione massima di priorità all' executive
+		try {
+			rt::set_priority(cores[c].exec_thread, rt::priority::rt_max);
+		}
+		catch (const rt::permission_error& e) {
+			rtlog::error("[ERROR] Impossibile impostare la priorità dell'executive: {}", e.what());
 		}
+	}
+}
+
+Executive::run_summary Executive::wait()
+{
+	assert(running);
+	for (auto & c: cores)
+		c.exec_thread.join();
+	const auto exec_end = std::chrono::steady_clock::now();
+	// da qui richieste AP, cambi di modalità e stop() vengono ignorati
+	running.store(false, std::memory_order_release);
+
+	run_summary summary{};
+	stop_tasks(summary);
+	if (rttrace::active())
+	{
+		const uint64_t dropped = rttrace::stop();
+		rtlog::info("[TRACE] Traccia scritta in {}, {} eventi scartati (ring pieni)", trace_path.c_str(), dropped);
+	}
+
+	const run_summary total = totals();
+	summary.frames = cores[0].timer->frame();
+	for (auto & c: cores)
+	{
+		summary.overruns += c.timer->overruns();
+		summary.skipped_frames += c.timer->skipped();
+	}
+	summary.jobs = total.jobs - run_base.jobs;
+	summary.misses = total.misses - run_base.misses;
+	summary.skipped = total.skipped - run_base.skipped;
+	summary.aborted = total.aborted - run_base.aborted;
+	summary.ap_jobs = total.ap_jobs - run_base.ap_jobs;
+	summary.ap_accepted = total.ap_accepted - run_base.ap_accepted;
+	summary.ap_rejected = total.ap_rejected - run_base.ap_rejected;
+	summary.ap_misses = total.ap_misses - run_base.ap_misses;
+	summary.duration = std::max(std::chrono::steady_clock::duration::zero(), exec_end - start_time);
+	summary.drain_time = std::chrono::steady_clock::now() - exec_end;
+
+	rtlog::info("[SUMMARY] {} frame, {} job completati, {} deadline miss, {} overrun",
+	            summary.frames, summary.jobs, summary.misses, summary.overruns);
+	if (!ap_tasks.empty())
+		rtlog::info("[SUMMARY] Task aperiodici: {} job, {} richieste accettate, {} rifiutate, {} scartate",
+		            summary.ap_jobs, summary.ap_accepted, summary.ap_rejected, summary.ap_dropped);
+	rtlog::info("[SUMMARY] Durata {} ms, terminazione dei task {} us",
+	            std::chrono::duration_cast<std::chrono::milliseconds>(summary.duration).count(),
+	            std::chrono::duration_cast<std::chrono::microseconds>(summary.drain_time).count());
+	if (wcet_profiling)
+		log_wcet_report(get_mode());
+	// il drain si ferma con l'esecuzione: scrive tutto e non sopravvive al processo (start() lo riavvia)
+	rtlog::stop();
+
+	reset_run();
+	return summary;
+}
+
+Executive::run_summary Executive::run_for(uint64_t frames)
+{
+	assert(frames > 0 && !running);
+	stop_frame.store(frames, std::memory_order_release);
+	start();
+	return wait();
+}
+
+void Executive::stop()
+{
+	if (!running.load(std::memory_order_acquire))
+		return;
+
+	// primo confine non ancora raggiunto (se un executive lo sta già passando, esce al confine successivo)
+	const uint64_t frame = clock_frame() + 1;
+	uint64_t current = stop_frame.load(std::memory_order_acquire);
+	while (frame < current && !stop_frame.compare_exchange_weak(current, frame, std::memory_order_acq_rel))
+		;
+}
+
+uint64_t Executive::clock_frame() const
+{
+	const int64_t frame_period = std::chrono::duration_cast<std::chrono::nanoseconds>(frame_length * unit_time).count();
+	return std::max<int64_t>(0, now_ns() - to_ns(start_time)) / frame_period;
 }
 
-void Executive::wait()
+Executive::run_summary Executive::totals() const
 {
-	exec_thread.join();
-	if (ap_task_set) {
-		ap_task.thread.join();
+	run_summary total{};
+	for (auto & task: p_tasks)
+	{
+		total.jobs += task.response_time.snapshot().count;
+		total.misses += task.misses.load(std::memory_order_relaxed);
+		total.skipped += task.skipped.load(std::memory_order_relaxed);
+		total.aborted += task.aborted.load(std::memory_order_relaxed);
+	}
+	for (auto & ap: ap_tasks)
+	{
+		total.ap_jobs += ap->response_time.snapshot().count;
+		total.ap_accepted += ap->accepted.load(std::memory_order_relaxed);
+		total.ap_rejected += ap->rejected.load(std::memory_order_relaxed);
+		total.ap_misses += ap->misses.load(std::memory_order_relaxed);
 	}
+	return total;
+}
+
+void Executive::stop_tasks(Executive::run_summary & summary)
+{
+	// gli executive sono usciti: restano solo job in ritardo (o richieste AP già rilasciate) da completare;
+	// un task fermo (IDLE/DONE) passa a STOPPED e il suo thread, risvegliato, esce
+	auto stop_task = [](task_data & task) {
+		while (!change_state(task, TaskState::IDLE, TaskState::STOPPED) &&
+		       !change_state(task, TaskState::DONE, TaskState::STOPPED))
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		rt::futex_wake(task.state);
+	};
+
+	for (auto & task: p_tasks)
+		stop_task(task);
+	for (auto & ap: ap_tasks)
+	{
+		stop_task(*ap);
+		// richieste accettate per frame che non ci saranno
+		ap_request req;
+		while (ap->requests.pop(req))
+			++summary.ap_dropped;
+		ap->queued.store(0, std::memory_order_relaxed);
+	}
+
+	for (auto & ap: ap_tasks)
+		ap->thread.join();
 	for (auto & pt: p_tasks)
-		pt.thread.join();
+		if (pt.thread.joinable())  // nessun thread con l'esecuzione inline
+			pt.thread.join();
+}
+
+void Executive::reset_run()
+{
+	for (auto & task: p_tasks)
+	{
+		task.state.store(static_cast<int>(TaskState::IDLE), std::memory_order_relaxed);
+		task.precedence.store(0, std::memory_order_relaxed);
+		task.released = false;
+		task.cancelled.store(false, std::memory_order_relaxed);
+		task.degraded.store(false, std::memory_order_relaxed);
+	}
+	for (auto & ap: ap_tasks)
+	{
+		ap->state.store(static_cast<int>(TaskState::IDLE), std::memory_order_relaxed);
+		ap->last_arrival.store(INT64_MIN / 2, std::memory_order_relaxed);
+		ap->deadline_frame.store(0, std::memory_order_relaxed);
+		ap->missed_frame.store(0, std::memory_order_relaxed);
+	}
+
+	// i frame ripartono da 0: le riserve di slack e lo stato delle modalità si riferiscono ai frame assoluti
+	for (auto & cell: reserved_slack)
+		cell.store(0, std::memory_order_relaxed);
+	ap_frame.store(0, std::memory_order_relaxed);
+	mode_state.store(0, std::memory_order_relaxed);
+	mode_request.store(0, std::memory_order_relaxed);
+	mode_busy.store(false, std::memory_order_relaxed);
+	stop_frame.store(UINT64_MAX, std::memory_order_release);
 }
 /* ------------------------------------------------------------------ */
 /*  Richiesta asincrona AP task                                       */
 /* ------------------------------------------------------------------ */
-void Executive::ap_task_request()
-{
-	//deposita solo il flag sotto mutex
-	std::lock_guard<std::mutex> lock(ap_task.mtx);
-    if (ap_task.state == TaskState::IDLE ||
-        ap_task.state == TaskState::DONE)
-        ap_task_requested_this_frame = true;
-    //Vecchio codice di ap_task_request
-	/* if (ap_task_requested_this_frame) {
-		std::cerr << "[ERROR] Il task aperiodico è già stato richiesto in questo frame" << std::endl;
-		return;
+unsigned int Executive::slack_of(uint64_t frame) const
+{
+	// la richiesta si legge prima dello stato: se nel frattempo il cambio è stato applicato, indicano la stessa modalità
+	const uint64_t request = mode_request.load(std::memory_order_seq_cst);
+	const uint64_t state = mode_state.load(std::memory_order_acquire);
+	return slack_under(request, state, frame);
+}
+
+unsigned int Executive::slack_under(uint64_t request, uint64_t state, uint64_t frame) const
+{
+	// un cambio non ancora fissato non tocca lo slack: chi prenota nel frattempo lo vede cambiare e riprova
+	uint64_t mode = state >> mode_shift, start = state & mode_frame_mask;
+	if (request != 0 && (request & mode_frame_mask) != 0 && frame >= (request & mode_frame_mask))
+	{
+		mode = (request >> mode_shift) - 1;
+		start = request & mode_frame_mask;
 	}
 
-	if (ap_task.state == TaskState::READY || ap_task.state == TaskState::RUNNING) {
-		std::cerr << "[ERROR] Il task aperiodico è già in esecuzione o richiesto" << std::endl;
-		return;
-	} */
+	const std::vector<unsigned int> & slack = modes[mode].cores[0].slack;
+	return frame >= start ? slack[(frame - start) % slack.size()] : 0;
+}
+
+static unsigned int reserved_in(uint64_t cell, uint64_t frame)
+{
+	return (cell >> 16) == frame ? static_cast<unsigned int>(cell & 0xFFFF) : 0;
+}
+
+bool Executive::reserve_slack(uint64_t first_frame, uint64_t end_frame, unsigned int units, unsigned int * taken)
+{
+	unsigned int left = units;
+
+	// riserva dai frame più vicini; ogni cella si aggiorna con una CAS, senza lock
+	for (uint64_t k = first_frame; k < end_frame; ++k)
+	{
+		std::atomic<uint64_t> & cell = reserved_slack[k % max_ap_deadline];
+		uint64_t word = cell.load(std::memory_order_acquire);
+		unsigned int take = 0;
+
+		while (left > 0 && (word >> 16) <= k)
+		{
+			unsigned int used = reserved_in(word, k);
+			const unsigned int slack = slack_of(k);
+			take = std::min(left, slack > used ? slack - used : 0);
+			// seq_cst: ordinata rispetto alla pubblicazione di un cambio di modalità (vedi admit_ap_request)
+			if (take == 0 || cell.compare_exchange_weak(word, (k << 16) | (used + take), std::memory_order_seq_cst))
+				break;
+			take = 0;
+		}
+
+		taken[k - first_frame] = take;
+		left -= take;
+	}
+
+	if (left > 0)
+		unreserve_slack(first_frame, end_frame, taken);
+	return left == 0;
+}
+
+void Executive::unreserve_slack(uint64_t first_frame, uint64_t end_frame, const unsigned int * taken)
+{
+	for (uint64_t k = first_frame; k < end_frame; ++k)
+	{
+		std::atomic<uint64_t> & cell = reserved_slack[k % max_ap_deadline];
+		uint64_t word = cell.load(std::memory_order_acquire);
+		while (taken[k - first_frame] > 0 && (word >> 16) == k &&
+		       !cell.compare_exchange_weak(word, word - taken[k - first_frame], std::memory_order_acq_rel))
+			;
+	}
+}
 
-	/* ap_task.state = TaskState::READY;
-	ap_task.cv.notify_one(); */
-	
+bool Executive::ap_task_request(size_t ap_id)
+{
+	// task inesistente o executive non in esecuzione
+	if (ap_id >= ap_tasks.size() || !running.load(std::memory_order_acquire))
+		return false;
+
+	const bool accepted = admit_ap_request(*ap_tasks[ap_id], now_ns(), ap_frame.load(std::memory_order_acquire));
+	rttrace::record(rttrace::AP_REQUEST, ap_id, accepted);
+	return accepted;
+}
+
+bool Executive::admit_ap_request(Executive::ap_task_data & ap, int64_t arrival, uint64_t frame)
+{
+	// task sporadico: rifiuta le richieste più ravvicinate della distanza minima
+	int64_t last = ap.last_arrival.load(std::memory_order_acquire);
+	if (ap.min_interarrival > 0)
+	{
+		const int64_t min_gap = std::chrono::duration_cast<std::chrono::nanoseconds>(ap.min_interarrival * frame_length * unit_time).count();
+		if (arrival - last < min_gap || !ap.last_arrival.compare_exchange_strong(last, arrival))
+		{
+			ap.rejected.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+	}
+
+	// il job può partire dall'inizio del frame successivo e deve terminare entro "deadline" frame
+	const uint64_t first = frame + 1;
+	const uint64_t end = first + ap.deadline;
+	unsigned int taken[max_ap_deadline];
+
+	// se nel frattempo un executive ha fissato un cambio di modalità, la prenotazione potrebbe usare lo slack
+	// sbagliato: si annulla e si riprova. O la seconda lettura vede il cambio, o l'executive vede la prenotazione
+	// quando controlla lo slack prenotato (reservations_fit)
+	bool accepted;
+	while (true)
+	{
+		const uint64_t request = mode_request.load(std::memory_order_seq_cst);
+		accepted = reserve_slack(first, end, ap.wcet, taken);
+		if (!accepted || mode_request.load(std::memory_order_seq_cst) == request)
+			break;
+		unreserve_slack(first, end, taken);
+	}
+	if (accepted && !ap.requests.push(ap_request{arrival, first, end}))
+	{
+		unreserve_slack(first, end, taken);
+		accepted = false;
+	}
+
+	if (!accepted)
+	{
+		int64_t mine = arrival;
+		if (ap.min_interarrival > 0)
+			ap.last_arrival.compare_exchange_strong(mine, last);
+		ap.rejected.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	ap.queued.fetch_add(1, std::memory_order_release);
+	ap.accepted.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+/* ------------------------------------------------------------------ */
+/*  Statistiche                                                       */
+/* ------------------------------------------------------------------ */
+Executive::task_stats Executive::get_task_stats(size_t task_id) const
+{
+	assert(task_id < p_tasks.size());
+	const task_data & task = p_tasks[task_id];
+	return task_stats{task.release_jitter.snapshot(), task.response_time.snapshot(), task.misses.load(), 0, 0,
+	                  task.skipped.load(), task.aborted.load()};
+}
+
+Executive::task_stats Executive::get_ap_task_stats(size_t ap_id) const
+{
+	assert(ap_id < ap_tasks.size());
+	const ap_task_data & ap = *ap_tasks[ap_id];
+	return task_stats{ap.release_jitter.snapshot(), ap.response_time.snapshot(), ap.misses.load(),
+	                  ap.accepted.load(), ap.rejected.load(), 0, 0};
+}
+
+Executive::perf_stats Executive::get_task_perf(size_t task_id) const
+{
+	assert(task_id < p_tasks.size());
+	return perf_snapshot(p_tasks[task_id].perf.get());
+}
+
+Executive::perf_stats Executive::get_ap_task_perf(size_t ap_id) const
+{
+	assert(ap_id < ap_tasks.size());
+	return perf_snapshot(ap_tasks[ap_id]->perf.get());
+}
+
+Executive::wcet_profile Executive::profile_of(const Executive::task_data & task) const
+{
+	wcet_profile profile{};
+	profile.wcet = task.wcet;
+	profile.status = WcetStatus::UNMEASURED;
+	if (!task.exec_time)
+		return profile;
+	profile.exec_time = task.exec_time->snapshot();
+	if (profile.exec_time.count == 0)
+		return profile;
+
+	profile.max_units = profile.exec_time.max / std::chrono::duration<double, std::nano>(unit_time).count();
+	profile.suggested = std::max(1u, static_cast<unsigned int>(std::ceil(profile.max_units * wcet_margin)));
+	if (profile.max_units > task.wcet)
+		profile.status = WcetStatus::OVER;
+	else if (profile.suggested > task.wcet)
+		profile.status = WcetStatus::NEAR;
+	else
+		profile.status = WcetStatus::OK;
+	return profile;
+}
+
+Executive::wcet_profile Executive::get_wcet_profile(size_t task_id) const
+{
+	assert(task_id < p_tasks.size());
+	return profile_of(p_tasks[task_id]);
+}
+
+Executive::wcet_profile Executive::get_ap_wcet_profile(size_t ap_id) const
+{
+	assert(ap_id < ap_tasks.size());
+	return profile_of(*ap_tasks[ap_id]);
+}
+
+std::vector<Executive::frame_utilisation> Executive::get_frame_utilisation(const std::string & mode) const
+{
+	assert(started);
+	size_t m = 0;
+	while (m < modes.size() && modes[m].name != mode)
+		++m;
+	assert(m < modes.size());
+
+	std::vector<wcet_profile> profiles;
+	for (auto & task: p_tasks)
+		profiles.push_back(profile_of(task));
+
+	std::vector<frame_utilisation> frames;
+	for (unsigned int c = 0; c < cores.size(); ++c)
+	{
+		const core_table & table = modes[m].cores[c];
+		for (size_t f = 0; f + 1 < table.frame_begin.size(); ++f)
+		{
+			frame_utilisation u{c, f, 0, 0, 0};
+			for (size_t i = table.frame_begin[f]; i < table.frame_begin[f + 1]; ++i)
+			{
+				const wcet_profile & p = profiles[table.tasks[i]];
+				const bool measured = p.status != WcetStatus::UNMEASURED;
+				u.declared += p.wcet;
+				u.observed += measured ? p.max_units : p.wcet;
+				u.suggested += measured ? p.suggested : p.wcet;
+			}
+			frames.push_back(u);
+		}
+	}
+	return frames;
+}
+
+void Executive::log_wcet_report(const std::string & mode) const
+{
+	auto log_profile = [](const char * kind, size_t id, const wcet_profile & p) {
+		if (p.status == WcetStatus::UNMEASURED)
+		{
+			rtlog::info("[WCET] Task {}{}: wcet {}, nessun job misurato", kind, id, p.wcet);
+			return;
+		}
+		rtlog::info("[WCET] Task {}{}: {} job, tempo di CPU p99 {} us", kind, id, p.exec_time.count, p.exec_time.percentile(0.99) / 1000.0);
+		if (p.status == WcetStatus::OVER)
+			rtlog::warn("[WCET] Task {}{}: massimo {} quanti OLTRE il wcet {}", kind, id, p.max_units, p.wcet);
+		else if (p.status == WcetStatus::NEAR)
+			rtlog::warn("[WCET] Task {}{}: massimo {} quanti, vicino al wcet {}", kind, id, p.max_units, p.wcet);
+		else
+			rtlog::info("[WCET] Task {}{}: massimo {} quanti, wcet {}", kind, id, p.max_units, p.wcet);
+		if (p.suggested != p.wcet)
+			rtlog::info("[WCET] Task {}{}: wcet suggerito {}", kind, id, p.suggested);
+	};
+
+	for (size_t id = 0; id < p_tasks.size(); ++id)
+		log_profile("", id, profile_of(p_tasks[id]));
+	for (auto & ap: ap_tasks)
+		log_profile("AP ", ap->id, profile_of(*ap));
+
+	for (auto & u: get_frame_utilisation(mode))
+	{
+		const double declared = 100.0 * u.declared / frame_length;
+		const double observed = 100.0 * u.observed / frame_length;
+		if (u.suggested > frame_length)
+			rtlog::warn("[WCET] Core {}, frame {}: utilizzo {}%, con i wcet suggeriti oltre il frame ({} quanti)",
+			            u.core, u.frame, observed, u.suggested);
+		else
+			rtlog::info("[WCET] Core {}, frame {}: utilizzo dichiarato {}%, osservato {}%", u.core, u.frame, declared, observed);
+	}
+}
+
+histogram_snapshot Executive::get_frame_lateness(unsigned int core) const
+{
+	assert(core < cores.size());
+	return cores[core].frame_lateness.snapshot();
+}
+
+histogram_snapshot Executive::get_dispatcher_cpu_time(unsigned int core) const
+{
+	assert(core < cores.size());
+	return cores[core].dispatch_cpu.snapshot();
+}
+
+uint64_t Executive::get_frame_overruns(unsigned int core) const
+{
+	assert(core < cores.size());
+	return cores[core].timer ? cores[core].timer->overruns() : 0;
+}
+
+uint64_t Executive::get_skipped_frames(unsigned int core) const
+{
+	assert(core < cores.size());
+	return cores[core].timer ? cores[core].timer->skipped() : 0;
+}
+
+Executive::startup_report Executive::get_startup_report() const
+{
+	return startup;
+}
+
+bool Executive::request_mode(const std::string & name)
+{
+	size_t mode = 0;
+	while (mode < modes.size() && modes[mode].name != name)
+		++mode;
+	// modalità inesistente, executive non in esecuzione o cambio precedente non ancora applicato
+	if (mode == modes.size() || !running.load(std::memory_order_acquire) || mode_busy.exchange(true, std::memory_order_acq_rel))
+		return false;
+
+	const uint64_t state = mode_state.load(std::memory_order_acquire);
+	if ((state >> mode_shift) == mode)
+	{
+		mode_busy.store(false, std::memory_order_release);
+		return true;
+	}
+
+	// il frame del cambio lo fissa il primo executive che vede la richiesta: calcolato qui, un thread
+	// interrotto prima di pubblicarlo potrebbe indicare un frame che qualche core ha già iniziato
+	mode_request_time.store(now_ns(), std::memory_order_relaxed);
+	mode_switched.store(0, std::memory_order_relaxed);
+	mode_request.store(uint64_t(mode + 1) << mode_shift, std::memory_order_seq_cst);
+	return true;
+}
+
+uint64_t Executive::fix_mode_request(uint64_t request, uint64_t frame)
+{
+	// primo confine di iperperiodo dopo il frame di questo executive e quello del clock: nessun core l'ha
+	// ancora iniziato, e ci arriva almeno un frame dopo la pubblicazione
+	const uint64_t state = mode_state.load(std::memory_order_acquire);
+	const uint64_t start = state & mode_frame_mask;
+	const uint64_t hyperperiod = modes[state >> mode_shift].frames.size();
+	const uint64_t after = std::max(frame, clock_frame()) + 1;
+	uint64_t target = start + (after - start + hyperperiod - 1) / hyperperiod * hyperperiod;
+
+	// lo fissa un solo executive, gli altri usano il suo
+	uint64_t expected = request;
+	if (!mode_request.compare_exchange_strong(expected, request | target, std::memory_order_seq_cst))
+		return expected;
+
+	// lo slack già prenotato nei frame dopo il cambio deve stare in quello della nuova modalità, altrimenti
+	// il cambio slitta (le prenotazioni arrivano al più a max_ap_deadline frame: prima o poi ci stanno)
+	while (!reservations_fit(request | target))
+	{
+		target += hyperperiod;
+		mode_request.store(request | target, std::memory_order_seq_cst);
+	}
+	return request | target;
+}
+
+bool Executive::reservations_fit(uint64_t request) const
+{
+	const uint64_t state = mode_state.load(std::memory_order_acquire);
+	for (auto & cell: reserved_slack)
+	{
+		const uint64_t word = cell.load(std::memory_order_seq_cst);
+		const uint64_t k = word >> 16;
+		if (k >= (request & mode_frame_mask) && (word & 0xFFFF) > slack_under(request, state, k))
+			return false;
+	}
+	return true;
+}
+
+size_t Executive::get_core_cpu(unsigned int core) const
+{
+	assert(core < cores.size());
+	return cores[core].cpu;
+}
+
+const std::string & Executive::get_mode() const
+{
+	return modes[mode_state.load(std::memory_order_acquire) >> mode_shift].name;
+}
+
+histogram_snapshot Executive::get_mode_switch_latency() const
+{
+	return mode_latency.snapshot();
 }
 /* ------------------------------------------------------------------ */
 /*  Funzione dei singoli task                                         */
 /* ------------------------------------------------------------------ */
-void Executive::task_function(Executive::task_data & task)
+TaskState Executive::get_state(const task_data & task)
+{
+	return static_cast<TaskState>(task.state.load(std::memory_order_acquire));
+}
+
+bool Executive::change_state(task_data & task, TaskState from, TaskState to)
+{
+	int expected = static_cast<int>(from);
+	return task.state.compare_exchange_strong(expected, static_cast<int>(to), std::memory_order_acq_rel);
+}
+
+bool Executive::release(task_data & task)
+{
+	// solo l'executive porta un task in READY, e solo da IDLE o DONE
+	if (!change_state(task, TaskState::IDLE, TaskState::READY) &&
+	    !change_state(task, TaskState::DONE, TaskState::READY))
+		return false;
+
+	rt::futex_wake(task.state);
+	return true;
+}
+
+Executive::release_outcome Executive::release_periodic(Executive::task_data & task)
 {
 	while (true) {
-		std::unique_lock<std::mutex> lock(task.mtx);
-		task.cv.wait(lock, [&task]() { return task.state == TaskState::READY; });
-		task.state = TaskState::RUNNING;
-		lock.unlock();
+		if (change_state(task, TaskState::IDLE, TaskState::READY) ||
+		    change_state(task, TaskState::DONE, TaskState::READY))
+			return RELEASED;
 
-		task.function();
+		// il job precedente è ancora in ritardo: il rilascio si differisce (o si salta, con SKIP_NEXT)
+		if (task.miss_policy == MissPolicy::SKIP_NEXT || get_state(task) != TaskState::LATE)
+			break;
+		if (change_state(task, TaskState::LATE, TaskState::PENDING))
+			return DEFERRED;
+		// il job in ritardo è appena terminato: si riprova
+	}
+
+	task.skipped.fetch_add(1, std::memory_order_relaxed);
+	return SKIPPED;
+}
 
-		lock.lock();
-		task.state = TaskState::DONE;
-		task.cv_done.notify_one();
+Executive::miss_outcome Executive::check_periodic_miss(Executive::task_data & task)
+{
+	while (true) {
+		switch (get_state(task)) {
+			case TaskState::READY:
+				// il job non è mai partito: viene scartato
+				if (change_state(task, TaskState::READY, TaskState::IDLE)) {
+					task.misses.fetch_add(1, std::memory_order_relaxed);
+					return MISSED;
+				}
+				break;
+			case TaskState::PENDING:
+				// il rilascio differito non è partito: viene scartato, il job precedente resta in ritardo
+				if (change_state(task, TaskState::PENDING, TaskState::LATE)) {
+					task.misses.fetch_add(1, std::memory_order_relaxed);
+					return MISSED;
+				}
+				break;
+			case TaskState::RUNNING:
+				if (change_state(task, TaskState::RUNNING, TaskState::LATE)) {
+					task.misses.fetch_add(1, std::memory_order_relaxed);
+					if (task.miss_policy == MissPolicy::ABORT)
+						task.cancelled.store(true, std::memory_order_relaxed);
+					else if (task.miss_policy == MissPolicy::DEGRADE)
+						task.degraded.store(true, std::memory_order_relaxed);
+					return NOW_LATE;
+				}
+				break;
+			default:
+				return ON_TIME;
+		}
 	}
 }
 
-void Executive::exec_function()
+bool Executive::precedence_arrive(Executive::task_data & task, uint64_t frame, unsigned int arrivals)
 {
-	rt::affinity core0(1);
-	rt::this_thread::set_affinity(core0);
+	uint64_t current = task.precedence.load(std::memory_order_acquire);
+	while (true) {
+		const uint64_t current_frame = current >> precedence_shift;
+		// arrivo per un frame già superato, o per un job già rilasciato o scartato
+		if (current_frame > frame || (current_frame == frame && (current & precedence_mask) >= precedence_armed))
+			return false;
+		const uint64_t count = (current_frame == frame ? current & precedence_mask : 0) + arrivals;
+		if (task.precedence.compare_exchange_weak(current, (frame << precedence_shift) | count, std::memory_order_acq_rel))
+			return count == precedence_armed;
+	}
+}
+
+bool Executive::precedence_cancel(Executive::task_data & task, uint64_t frame)
+{
+	uint64_t current = task.precedence.load(std::memory_order_acquire);
+	while ((current >> precedence_shift) == frame && (current & precedence_mask) < precedence_armed)
+		if (task.precedence.compare_exchange_weak(current, (frame << precedence_shift) | precedence_cancelled,
+		                                          std::memory_order_acq_rel))
+			return true;
+	return false;
+}
+
+void Executive::warm_up(Executive::task_data & task, void (*job)(task_data &))
+{
+	current_task = &task;
+
+	// stack e ring del log già mappati, stato della funzione (e cache) già caricati al primo rilascio
+	task.thread_prio.bind_tid(rt::this_thread::tid());
+	rt::prefault_stack(warmup_stack);
+	rtlog::register_thread();
+	if (rttrace::active())
+		rttrace::register_thread(trace_events);
+	// i contatori contano il thread che li apre (quelli di un'esecuzione precedente sono del vecchio thread)
+	if (task.perf)
+	{
+		task.perf->counters.reset(new rt::perf_counters());
+		mark_available(*task.perf, *task.perf->counters);
+	}
+	for (unsigned int i = 0; i < warmup_jobs; ++i)
+		job(task);
+
+	if (warming.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		rt::futex_wake(warming);
+}
+
+bool Executive::wait_release(Executive::task_data & task, int64_t & release_time)
+{
+	while (true) {
+		int state = task.state.load(std::memory_order_acquire);
+		if (state == static_cast<int>(TaskState::STOPPED))
+			return false;
+		if (state != static_cast<int>(TaskState::READY)) {
+			rt::futex_wait(task.state, state);
+			continue;
+		}
+		if (change_state(task, TaskState::READY, TaskState::RUNNING)) {
+			release_time = begin_job(task);
+			return true;
+		}
+	}
+}
+
+int64_t Executive::begin_job(Executive::task_data & task)
+{
+	task.cancelled.store(false, std::memory_order_relaxed);
+
+	int64_t release_time = task.release_time.load(std::memory_order_relaxed);
+	rttrace::record(rttrace::START, task.trace_id, release_time);
+	task.release_jitter.record(std::max<int64_t>(0, now_ns() - release_time));
+	return release_time;
+}
+
+bool Executive::end_job(Executive::task_data & task, int64_t & release_time)
+{
+	rttrace::record(rttrace::FINISH, task.trace_id, task.cancelled.load(std::memory_order_relaxed));
+	if (task.cancelled.load(std::memory_order_relaxed))
+		task.aborted.fetch_add(1, std::memory_order_relaxed);
+	else
+		task.response_time.record(std::max<int64_t>(0, now_ns() - release_time));
+
+	// job in tempo (RUNNING), in ritardo (LATE) o in ritardo con un rilascio differito (PENDING)
+	while (true) {
+		if (change_state(task, TaskState::RUNNING, TaskState::DONE)) {
+			task.degraded.store(false, std::memory_order_relaxed);
+			return false;
+		}
+		if (change_state(task, TaskState::LATE, TaskState::DONE))
+			return false;
+		if (get_state(task) == TaskState::PENDING) {
+			// il rilascio differito parte subito, con la priorità che gli ha assegnato l'executive
+			set_release_priority(task);
+			if (change_state(task, TaskState::PENDING, TaskState::RUNNING)) {
+				release_time = begin_job(task);
+				return true;
+			}
+		}
+	}
+}
+
+bool Executive::uses_deadline(const Executive::task_data & task)
+{
+	return task.deadline.runtime.count() > 0 && !task.deadline_refused.load(std::memory_order_relaxed);
+}
+
+void Executive::set_release_priority(Executive::task_data & task)
+{
+	const bool deadline = uses_deadline(task);
+	try {
+		if (deadline)
+			task.thread_prio.set(task.deadline);
+		else
+			task.thread_prio.set(task.priority);
+		return;
+	} catch (const rt::permission_error& e) {
+		if (!deadline) {
+			rtlog::error("[ERROR] set_priority task: {}", e.what());
+			return;
+		}
+		// una sola segnalazione per task, poi resta sulla scala di priorità FIFO
+		if (!task.deadline_refused.exchange(true, std::memory_order_relaxed))
+			rtlog::error("[ERROR] SCHED_DEADLINE rifiutato ({}): il task resta SCHED_FIFO", e.what());
+	}
+
+	try {
+		task.thread_prio.set(task.priority);
+	} catch (const rt::permission_error& e) {
+		rtlog::error("[ERROR] set_priority task: {}", e.what());
+	}
+}
+
+void Executive::release_successors(Executive::task_data & task, int64_t release_time)
+{
+	if (task.successors.empty())
+		return;
+
+	// frame del job appena terminato (anche se differito): i successori attendono quello
+	const int64_t frame_period = std::chrono::duration_cast<std::chrono::nanoseconds>(frame_length * unit_time).count();
+	const uint64_t frame = std::max<int64_t>(0, release_time - to_ns(start_time)) / frame_period;
+	for (auto id: task.successors)
+		if (precedence_arrive(p_tasks[id], frame, 1))
+			release_held(p_tasks[id], frame);
+}
+
+void Executive::release_held(Executive::task_data & task, uint64_t frame)
+{
+	// priorità, parametri SCHED_DEADLINE e istante di rilascio li ha già impostati l'executive
+	release_outcome outcome = release_periodic(task);
+	if (outcome != SKIPPED)
+		rttrace::record(rttrace::RELEASE, task.trace_id, frame);
+	if (outcome == RELEASED) {
+		set_release_priority(task);
+		rt::futex_wake(task.state);
+	}
+	else if (outcome == SKIPPED)
+		rtlog::warn("[WARN] Task {} ancora in ritardo: rilascio saltato", &task - &p_tasks[0]);
+}
+
+bool Executive::count_ap_miss(Executive::ap_task_data & ap, uint64_t deadline_frame)
+{
+	// executive e thread del task possono accorgersi dello stesso ritardo: il job si conta una volta sola
+	uint64_t missed = ap.missed_frame.load(std::memory_order_acquire);
+	while (missed < deadline_frame)
+		if (ap.missed_frame.compare_exchange_weak(missed, deadline_frame, std::memory_order_acq_rel)) {
+			ap.misses.fetch_add(1, std::memory_order_relaxed);
+			rttrace::record(rttrace::MISS, ap.trace_id, deadline_frame);
+			return true;
+		}
+	return false;
+}
+
+void Executive::ap_task_function(Executive::ap_task_data & ap)
+{
+	warm_up(ap, &function_job::run);
+
+	while (true) {
+		int state = ap.state.load(std::memory_order_acquire);
+		if (state == static_cast<int>(TaskState::STOPPED))
+			return;
+		if (state != static_cast<int>(TaskState::READY)) {
+			rt::futex_wait(ap.state, state);
+			continue;
+		}
+		if (!change_state(ap, TaskState::READY, TaskState::RUNNING))
+			continue;
+
+		// esegue in sequenza le richieste in coda, ma nessuna prima del frame da cui ha slack riservato
+		ap_request req;
+		while (ap.requests.front(req) && req.first_frame <= ap_frame.load(std::memory_order_acquire)) {
+			ap.requests.pop(req);
+			ap.queued.fetch_sub(1, std::memory_order_release);
+
+			ap.deadline_frame.store(req.deadline_frame, std::memory_order_release);
+			ap.release_time.store(req.arrival, std::memory_order_relaxed);
+			ap.release_jitter.record(std::max<int64_t>(0, now_ns() - req.arrival));
+			rttrace::record(rttrace::START, ap.trace_id, req.arrival);
+
+			perf_sample sample;
+			if (ap.perf)
+				begin_perf(*ap.perf->counters, sample);
+			const auto cpu_begin = ap.exec_time ? rt::thread_cpu_time() : std::chrono::nanoseconds(0);
+			ap.function();
+			if (ap.exec_time)
+				record_exec_time(ap, cpu_begin);
+			if (ap.perf)
+				end_perf(*ap.perf, *ap.perf->counters, sample);
+
+			rttrace::record(rttrace::FINISH, ap.trace_id);
+			ap.response_time.record(std::max<int64_t>(0, now_ns() - req.arrival));
+			ap.deadline_frame.store(UINT64_MAX, std::memory_order_release);  // nessun job in corso
+			if (ap_frame.load(std::memory_order_acquire) >= req.deadline_frame)
+				count_ap_miss(ap, req.deadline_frame);
+		}
+
+		// le richieste arrivate nel frattempo vengono rilasciate dall'executive al frame successivo
+		change_state(ap, TaskState::RUNNING, TaskState::DONE);
+	}
+}
+
+/* ------------------------------------------------------------------ */
+/*  Contatori di prestazioni dei job                                  */
+/* ------------------------------------------------------------------ */
+Executive::perf_record::perf_record()
+{
+	for (size_t c = 0; c < rt::perf_counters::num_counters; ++c)
+	{
+		available[c].store(false, std::memory_order_relaxed);
+		total[c].store(0, std::memory_order_relaxed);
+		max[c].store(0, std::memory_order_relaxed);
+		slowest[c].store(0, std::memory_order_relaxed);
+	}
+	jobs.store(0, std::memory_order_relaxed);
+	slowest_time.store(0, std::memory_order_relaxed);
+}
+
+void Executive::mark_available(Executive::perf_record & record, const rt::perf_counters & counters)
+{
+	for (size_t c = 0; c < rt::perf_counters::num_counters; ++c)
+		record.available[c].store(counters.available(static_cast<rt::perf_counters::counter>(c)), std::memory_order_relaxed);
+}
+
+void Executive::begin_perf(const rt::perf_counters & counters, Executive::perf_sample & sample)
+{
+	sample.time = now_ns();
+	counters.read(sample.counters);
+}
+
+void Executive::end_perf(Executive::perf_record & record, const rt::perf_counters & counters, const Executive::perf_sample & sample)
+{
+	rt::perf_counters::sample after;
+	counters.read(after);
+	const int64_t time = now_ns() - sample.time;
+
+	// un solo thread scrive il record: basta load + store, i lettori vedono i campi aggiornati uno alla volta
+	const bool slowest = time > record.slowest_time.load(std::memory_order_relaxed);
+	for (size_t c = 0; c < rt::perf_counters::num_counters; ++c)
+	{
+		const uint64_t delta = after.value[c] - sample.counters.value[c];
+		record.total[c].store(record.total[c].load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+		if (delta > record.max[c].load(std::memory_order_relaxed))
+			record.max[c].store(delta, std::memory_order_relaxed);
+		if (slowest)
+			record.slowest[c].store(delta, std::memory_order_relaxed);
+	}
+	if (slowest)
+		record.slowest_time.store(time, std::memory_order_relaxed);
+	record.jobs.store(record.jobs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void Executive::record_exec_time(Executive::task_data & task, std::chrono::nanoseconds cpu_begin)
+{
+	// un job interrotto non dice nulla sul suo wcet
+	if (!task.cancelled.load(std::memory_order_relaxed))
+		task.exec_time->record((rt::thread_cpu_time() - cpu_begin).count());
+}
+
+Executive::perf_stats Executive::perf_snapshot(const Executive::perf_record * record)
+{
+	perf_stats stats{};
+	if (!record)
+		return stats;
+	for (size_t c = 0; c < rt::perf_counters::num_counters; ++c)
+	{
+		stats.available[c] = record->available[c].load(std::memory_order_relaxed);
+		stats.total[c] = record->total[c].load(std::memory_order_relaxed);
+		stats.max[c] = record->max[c].load(std::memory_order_relaxed);
+		stats.slowest[c] = record->slowest[c].load(std::memory_order_relaxed);
+	}
+	stats.jobs = record->jobs.load(std::memory_order_relaxed);
+	stats.slowest_time = std::chrono::nanoseconds(record->slowest_time.load(std::memory_order_relaxed));
+	return stats;
+}
+
+void Executive::inline_overrun(void * core)
+{
+	// signal handler: solo operazioni atomiche lock-free
+	task_data * task = static_cast<core_data *>(core)->inline_task.load(std::memory_order_acquire);
+	if (task && task->miss_policy == MissPolicy::ABORT)
+		task->cancelled.store(true, std::memory_order_relaxed);
+}
+
+void Executive::dispatch_inline(size_t core, const core_table & table, size_t frame_id, rt::alarm * overrun,
+                                const rt::perf_counters * perf)
+{
+	core_data & c = cores[core];
+	const auto frame_end = c.timer->frame_start() + frame_length * unit_time;
+	const int64_t release_time = to_ns(c.timer->frame_start());
+	const int64_t deadline = to_ns(frame_end);
+	if (overrun)
+		overrun->arm(frame_end);
+
+	for (size_t i = table.frame_begin[frame_id]; i < table.frame_begin[frame_id + 1]; ++i) {
+		const size_t id = table.tasks[i];
+		task_data & task = p_tasks[id];
+		int64_t now = now_ns();
+		rttrace::record(rttrace::RELEASE, task.trace_id, c.timer->frame());
+		if (now >= deadline) {
+			// frame esaurito: il job non parte e viene scartato
+			task.misses.fetch_add(1, std::memory_order_relaxed);
+			rttrace::record(rttrace::MISS, task.trace_id, c.timer->frame());
+			rtlog::warn("[DEADLINE MISS] Task {} non avviato", id);
+			continue;
+		}
+
+		task.release_time.store(release_time, std::memory_order_relaxed);
+		task.cancelled.store(false, std::memory_order_relaxed);
+		task.release_jitter.record(std::max<int64_t>(0, now - release_time));
+		rttrace::record(rttrace::START, task.trace_id, release_time);
+		current_task = &task;
+		c.inline_task.store(&task, std::memory_order_release);
+		// il timer può essere scaduto prima che il task fosse visibile al signal handler
+		if (overrun && overrun->fired() && task.miss_policy == MissPolicy::ABORT)
+			task.cancelled.store(true, std::memory_order_relaxed);
+
+		perf_sample sample;
+		if (perf)
+			begin_perf(*perf, sample);
+		const auto cpu_begin = task.exec_time ? rt::thread_cpu_time() : std::chrono::nanoseconds(0);
+		(task.job ? task.job : &function_job::run)(task);
+		if (task.exec_time)
+			record_exec_time(task, cpu_begin);
+		if (perf)
+			end_perf(*task.perf, *perf, sample);
+
+		c.inline_task.store(nullptr, std::memory_order_release);
+		current_task = nullptr;
+		rttrace::record(rttrace::FINISH, task.trace_id, task.cancelled.load(std::memory_order_relaxed));
+		now = now_ns();
+		if (task.cancelled.load(std::memory_order_relaxed))
+			task.aborted.fetch_add(1, std::memory_order_relaxed);
+		else
+			task.response_time.record(std::max<int64_t>(0, now - release_time));
+
+		if (now < deadline)
+			task.degraded.store(false, std::memory_order_relaxed);
+		else {
+			// overrun: il job ha sforato il frame, i successivi del frame vengono scartati
+			task.misses.fetch_add(1, std::memory_order_relaxed);
+			rttrace::record(rttrace::MISS, task.trace_id, c.timer->frame());
+			if (task.miss_policy == MissPolicy::DEGRADE)
+				task.degraded.store(true, std::memory_order_relaxed);
+			rtlog::warn("[DEADLINE MISS] Task {}", id);
+		}
+	}
+
+	if (overrun)
+		overrun->disarm();
+}
+
+void Executive::exec_function(size_t core)
+{
+	rt::this_thread::set_affinity(rt::affinity::single(cores[core].cpu));
+	rt::prefault_stack(warmup_stack);
+	rtlog::register_thread();
+	// ring della traccia: a ogni frame un rilascio per task, più frame tra due scritture del file
+	if (rttrace::active())
+		rttrace::register_thread(std::max<size_t>(4096, 16 * cores[core].woken.capacity()));
+	auto & frame_id = cores[core].frame_id;
+	rt::frame_timer & timer = *cores[core].timer;
+	uint64_t frame_count = 0;  // frame assoluto, dall'avvio
+	// tabella della modalità in corso: al cambio si sostituisce solo il puntatore
+	const core_table * table = &modes[0].cores[core];
+	uint64_t mode_start = 0;       // frame assoluto in cui è iniziata la modalità in corso
+	uint64_t applied_request = 0;  // ultima richiesta di cambio già applicata da questo core
+	// esecuzione inline: timer di fine frame, notificato a questo thread
+	std::unique_ptr<rt::alarm> overrun;
+	if (inline_dispatch)
+	{
+		try {
+			overrun.reset(new rt::alarm(&Executive::inline_overrun, &cores[core]));
+		}
+		catch (const std::system_error& e) {
+			rtlog::error("[ERROR] Core {}: timer di overrun non disponibile, ABORT non interrompe i job: {}", core, e.what());
+		}
+	}
+	// esecuzione inline: i contatori dei job sono quelli di questo thread
+	std::unique_ptr<rt::perf_counters> perf;
+	if (inline_dispatch && perf_enabled)
+	{
+		perf.reset(new rt::perf_counters());
+		for (auto & task: p_tasks)
+			if (task.core == core)
+				mark_available(*task.perf, *perf);
+	}
 	frame_id = 0;
-	auto next_frame_time = std::chrono::steady_clock::now();
+	timer.wait_start();
+	cores[core].frame_lateness.record(std::max<int64_t>(0, now_ns() - to_ns(timer.frame_start())));
+	auto cpu_time = rt::thread_cpu_time();
 
 	while (true)
 	{
-		#ifdef VERBOSE
-		std::cout << "*** Frame n." << frame_id << (frame_id == 0 ? " ******" : "") << std::endl;
-		#endif
+		rttrace::record(rttrace::FRAME, core, frame_count);
+		// traccia dei frame (livello debug: si elimina compilando con RTLOG_LEVEL > 0)
+		if (cores.size() > 1)
+			rtlog::debug("[core {}] *** Frame n.{}{}", core, frame_id, frame_id == 0 ? " ******" : "");
+		else
+			rtlog::debug("*** Frame n.{}{}", frame_id, frame_id == 0 ? " ******" : "");
 
 	    /* ------------------------------------------------------------------
-         * 1) Legge e azzera la richiesta AP sotto mutex
+         * 1) Task aperiodici (solo core 0): attivi quelli con un job in corso o richieste in coda
          * ------------------------------------------------------------------ */
-        bool req_this_frame;
-        {
-            std::lock_guard<std::mutex> lock(ap_task.mtx);
-            req_this_frame = ap_task_requested_this_frame;
-            ap_task_requested_this_frame = false;
-        }
+        const int64_t frame_start = to_ns(timer.frame_start());
+        // slack stealing: i job AP girano sopra i periodici finchè c'è slack nel frame, poi sotto
+        const unsigned int slack = table->slack[frame_id];
+        bool ap_boosted = false;
+        if (core == 0 && !ap_tasks.empty()) {
+            ap_frame.store(frame_count, std::memory_order_release);
 
-        /* ------------------------------------------------------------------
-         * 2) Gestione eventuale task aperiodico
-         * ------------------------------------------------------------------ */
-        if (req_this_frame) {
-            std::unique_lock<std::mutex> lock(ap_task.mtx);
-
-            if (ap_task.state == TaskState::READY ||
-                ap_task.state == TaskState::RUNNING)
-            {
-                std::cerr << "[DEADLINE MISS] AP task ancora in esecuzione "
-                             "al nuovo rilascio\n";
-                ap_task.state = TaskState::DONE;
+            ap_active.clear();
+            for (auto & ap: ap_tasks) {
+                TaskState ap_state = get_state(*ap);
+                if (ap_state == TaskState::READY || ap_state == TaskState::RUNNING)
+                    ap->sort_deadline = ap->deadline_frame.load(std::memory_order_acquire);
+                else if (ap->queued.load(std::memory_order_acquire) > 0)
+                    // la richiesta più vecchia è arrivata nel frame precedente: scade tra "deadline" frame
+                    ap->sort_deadline = frame_count + ap->deadline;
+                else
+                    continue;
+
+                // inserimento in ordine di deadline (ap_active è preallocato)
+                auto pos = ap_active.end();
+                while (pos != ap_active.begin() && (*(pos - 1))->sort_deadline > ap->sort_deadline)
+                    --pos;
+                ap_active.insert(pos, ap.get());
+            }
+
+            /* ------------------------------------------------------------------
+             * 2) Priorità dei job AP attivi (ripristinata ad ogni frame, anche dopo un deadline miss)
+             * ------------------------------------------------------------------ */
+            ap_boosted = slack > 0 && !ap_active.empty();
+            auto ap_prio = ap_priority();
+            for (auto ap: ap_active) {
+                rttrace::record(rttrace::PRIORITY, ap->trace_id, (ap_boosted ? ap_prio : rt::priority::rt_min) - rt::priority::not_rt);
                 try {
-                    rt::set_priority(ap_task.thread, rt::priority::rt_min);
+                    ap->thread_prio.set(ap_boosted ? ap_prio-- : rt::priority::rt_min);
                 } catch (const rt::permission_error& e) {
-                    std::cerr << "[ERROR] set_priority AP: "
-                              << e.what() << '\n';
+                    rtlog::error("[ERROR] set_priority AP: {}", e.what());
                 }
-            } else {
-                ap_task.state = TaskState::READY;
-                ap_task.cv.notify_one();          // UNICO notify
+                release(*ap);  // solo per i task fermi (IDLE/DONE) con richieste in coda
             }
         }
 
         /* ------------------------------------------------------------------
-         * 3) Rilascio dei task periodici del frame corrente
+         * 3) Rilascio dei task periodici del frame corrente, con le priorità precalcolate:
+         *    prima tutte le transizioni di stato, poi priorità (solo se cambiano) e risvegli;
+         *    con l'esecuzione inline i job girano invece qui, uno dopo l'altro
          * ------------------------------------------------------------------ */
-        auto prio = rt::priority::rt_max - 1; // I task partono da priorità subito sotto l’executive
-		for (auto id : frames[frame_id]) {
-            auto& task = p_tasks[id];
-            std::unique_lock<std::mutex> lock(task.mtx);
+        auto & tasks = table->tasks;
+        auto & frame_begin = table->frame_begin;
+        auto & prios = table->priorities;
+        auto & woken = cores[core].woken;
+        woken.clear();
+        if (inline_dispatch)
+            dispatch_inline(core, *table, frame_id, overrun.get(), perf.get());
+        else
+		for (size_t i = frame_begin[frame_id]; i < frame_begin[frame_id + 1]; ++i) {
+            auto& task = p_tasks[tasks[i]];
+            task.priority = prios[i];
+            if (use_deadline)
+                task.deadline = table->deadlines[i];
+            task.release_time.store(frame_start, std::memory_order_relaxed);
+            if (table->predecessors[i] > 0) {
+                // attende i predecessori: lo rilascia l'ultimo che termina (o subito, se hanno già terminato tutti)
+                task.released = true;
+                if (!precedence_arrive(task, frame_count, precedence_armed - table->predecessors[i]))
+                    continue;
+            }
 
-            if (task.state == TaskState::IDLE || task.state == TaskState::DONE)
-            {
-                task.state = TaskState::READY;
+            release_outcome outcome = release_periodic(task);
+            if (outcome == RELEASED)
+                woken.push_back(&task);
+            else if (outcome == SKIPPED) {
+                rtlog::warn("[WARN] Task {} ancora in ritardo: rilascio saltato", tasks[i]);
+                continue;
+            }
+            rttrace::record(rttrace::RELEASE, task.trace_id, frame_count);
+            // differito: parte con questa priorità quando termina il job in ritardo
+            task.released = true;
+        }
+        // i task sono sullo stesso core dell'executive (rt_max): nessuno parte prima che l'executive dorma
+        // (con SCHED_DEADLINE ognuno parte appena risvegliato, nell'ordine della tabella)
+        for (auto task : woken) {
+            set_release_priority(*task);
+            rt::futex_wake(task->state);
+        }
 
-				try {
-					rt::set_priority(task.thread, prio);
-				} catch (const rt::permission_error& e) {
-					std::cerr << "[ERROR] set_priority task " << id
-					<< ": " << e.what() << '\n';
-				}
-				
-				task.cv.notify_one();
-				prio--; //Il task successivo avrà priorità minore
-            } else {
-                std::cerr << "[WARN] Task " << id
-                          << " in stato " << static_cast<int>(task.state)
-                          << " al rilascio\n";
+        /* ------------------------------------------------------------------
+         * 4) Esaurito lo slack del frame, i task AP scendono sotto i periodici
+         * ------------------------------------------------------------------ */
+        if (ap_boosted && slack < frame_length && !inline_dispatch) {
+            rt::sleep_until(timer.frame_start() + slack * unit_time);
+            for (auto ap: ap_active) {
+                TaskState ap_state = get_state(*ap);
+                if (ap_state == TaskState::READY || ap_state == TaskState::RUNNING) {
+                    rttrace::record(rttrace::PRIORITY, ap->trace_id, rt::priority::rt_min - rt::priority::not_rt);
+                    try {
+                        ap->thread_prio.set(rt::priority::rt_min);
+                    } catch (const rt::permission_error& e) {
+                        rtlog::error("[ERROR] set_priority AP: {}", e.what());
+                    }
+                }
             }
         }
 
         /* ------------------------------------------------------------------
-         * 4) Dorme fino all’inizio del prossimo frame 
+         * 5) Dorme fino all’inizio del prossimo frame (sleep assoluto): se il confine
+         *    è già passato è un overrun, gestito secondo la politica del timer
          * ------------------------------------------------------------------ */
-        next_frame_time += frame_length * unit_time;
-        std::this_thread::sleep_until(next_frame_time);
+        const uint64_t overruns = timer.overruns();
+        const uint64_t advance = timer.wait();
+        cores[core].frame_lateness.record(std::max<int64_t>(0, now_ns() - to_ns(timer.frame_start())));
+        const auto frame_cpu_time = rt::thread_cpu_time();
+        cores[core].dispatch_cpu.record((frame_cpu_time - cpu_time).count());
+        cpu_time = frame_cpu_time;
+        if (timer.overruns() != overruns)
+            rtlog::warn("[OVERRUN] Core {}: frame {} terminato oltre il confine, {} frame saltati",
+                        core, frame_count, advance - 1);
 
         /* ------------------------------------------------------------------
-         * 5) Verifica deadline-miss di tutti i task del frame appena chiuso
+         * 6) Verifica deadline-miss di tutti i task del frame appena chiuso
+         *    (i declassamenti si applicano dopo, tutti insieme)
          * ------------------------------------------------------------------ */
-        for (auto id : frames[frame_id]) {
+        auto & demoted = cores[core].demoted;
+        demoted.clear();
+        for (size_t i = frame_begin[frame_id]; i < frame_begin[frame_id + 1] && !inline_dispatch; ++i) {
+            const size_t id = tasks[i];
             auto& task = p_tasks[id];
-            std::lock_guard<std::mutex> lock(task.mtx);
+            if (!task.released)
+                continue;
+            task.released = false;
 
-            if (task.state != TaskState::DONE) {
-                std::cerr << "[DEADLINE MISS] Task " << id << '\n';
-                try {
-                    rt::set_priority(task.thread, rt::priority::rt_min);
-                } catch (const rt::permission_error& e) {
-                    std::cerr << "[ERROR] set_priority task " << id
-                              << ": " << e.what() << '\n';
-                }
-                task.state = TaskState::DONE;
+            // predecessori non terminati entro il frame: il job non viene rilasciato
+            if (table->predecessors[i] > 0 && precedence_cancel(task, frame_count)) {
+                task.misses.fetch_add(1, std::memory_order_relaxed);
+                rttrace::record(rttrace::MISS, task.trace_id, frame_count);
+                rtlog::warn("[DEADLINE MISS] Task {}: predecessori non terminati", id);
+                continue;
+            }
+
+            miss_outcome outcome = check_periodic_miss(task);
+            if (outcome != ON_TIME) {
+                rtlog::warn("[DEADLINE MISS] Task {}", id);
+                rttrace::record(rttrace::MISS, task.trace_id, frame_count);
+            }
+            // il job prosegue a priorità minima, la priorità si ripristina al prossimo rilascio; un task
+            // SCHED_DEADLINE resta nella sua riserva (il kernel lo limita già al budget di ogni periodo, e
+            // un thread sospeso per budget esaurito che cambia politica può non essere più riattivato)
+            if (outcome == NOW_LATE && !uses_deadline(task)) {
+                demoted.push_back(&task.thread_prio);
+                rttrace::record(rttrace::PRIORITY, task.trace_id, rt::priority::rt_min - rt::priority::not_rt);
             }
         }
 
-        if (ap_task_set) {
-            std::lock_guard<std::mutex> lock(ap_task.mtx);
-            if (ap_task.state == TaskState::READY ||
-                ap_task.state == TaskState::RUNNING)
-            {
-                std::cerr << "[DEADLINE MISS] Task aperiodico\n";
-                try {
-                    rt::set_priority(ap_task.thread, rt::priority::rt_min);
-                } catch (const rt::permission_error& e) {
-                    std::cerr << "[ERROR] set_priority AP: "<< e.what() << '\n';
+        // un job AP manca la deadline se è ancora in corso alla fine dell'ultimo frame concessogli:
+        // non viene interrotto, continua a priorità minima (il thread smaltisce poi il resto della coda)
+        if (core == 0) {
+            for (auto ap: ap_active) {
+                uint64_t deadline = ap->deadline_frame.load(std::memory_order_acquire);
+                if (get_state(*ap) == TaskState::RUNNING && timer.frame() >= deadline &&
+                    count_ap_miss(*ap, deadline))
+                {
+                    rtlog::warn("[DEADLINE MISS] Task aperiodico {}", ap->id);
+                    demoted.push_back(&ap->thread_prio);
+                    rttrace::record(rttrace::PRIORITY, ap->trace_id, rt::priority::rt_min - rt::priority::not_rt);
                 }
-                ap_task.state = TaskState::DONE;
             }
         }
 
+        for (auto thread_prio : demoted) {
+            try {
+                thread_prio->set(rt::priority::rt_min);
+            } catch (const rt::permission_error& e) {
+                rtlog::error("[ERROR] set_priority: {}", e.what());
+            }
+        }
+
+        /* ------------------------------------------------------------------
+         * 7) Passa al frame successivo (o a quello indicato dal timer, se ne ha saltati),
+         *    oppure esce se è stata chiesta la fine (run_for / stop): i job in ritardo li completa wait()
+         * ------------------------------------------------------------------ */
+        frame_count = timer.frame();
+        if (frame_count >= stop_frame.load(std::memory_order_acquire))
+            break;
+
         /* ------------------------------------------------------------------
-         * 6) Passa al frame successivo
+         * 8) Cambio di modalità: al confine di iperperiodo richiesto tutti i core passano alla nuova tabella
          * ------------------------------------------------------------------ */
-        frame_id = (frame_id + 1) % frames.size();
+        uint64_t request = mode_request.load(std::memory_order_acquire);
+        if (request != 0 && (request & mode_frame_mask) == 0)
+            request = fix_mode_request(request, frame_count);
+        if (request != 0 && request != applied_request && frame_count >= (request & mode_frame_mask)) {
+            const mode_data & mode = modes[(request >> mode_shift) - 1];
+            applied_request = request;
+            table = &mode.cores[core];
+            mode_start = request & mode_frame_mask;
+            timer.set_realign(mode_start, mode.frames.size());
+
+            // l'ultimo core a cambiare pubblica la nuova modalità e accetta nuove richieste
+            if (mode_switched.fetch_add(1, std::memory_order_acq_rel) + 1 == cores.size()) {
+                mode_state.store(request - (uint64_t(1) << mode_shift), std::memory_order_release);
+                const int64_t latency = now_ns() - mode_request_time.load(std::memory_order_relaxed);
+                mode_latency.record(latency);
+                rtlog::info("[MODE] Modalità {} dal frame {}, {} us dopo la richiesta", mode.name.c_str(), mode_start, latency / 1000);
+                mode_request.store(0, std::memory_order_release);
+                mode_busy.store(false, std::memory_order_release);
+            }
+        }
+        frame_id = (frame_count - mode_start) % table->slack.size();
     }
 }
\ No newline at end of file
@@ -4,16 +4,50 @@
 #include <vector>
 #include <functional>
 #include <chrono>
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
 #include <thread>
+#include <memory>
+#include <climits>
+#include <string>
+
+#include "histogram.h"
+#include "mpsc_queue.h"
+#include "rt/timer.h"
+#include "rt/priority.h"
+#include "rt/affinity.h"
+#include "rt/perf.h"
 
 // Stato dei task non più gestito da boolean 
 enum class TaskState {
 	IDLE,     
 	READY,    
 	RUNNING,  
-	DONE      
+	DONE,
+	LATE,     // job ancora in esecuzione oltre la deadline
+	PENDING,  // job in ritardo con un rilascio successivo in attesa (differito)
+	STOPPED   // esecuzione terminata: il thread del task esce
+};
+
+// Cosa fare quando un job periodico manca la deadline (vedi Executive::set_miss_policy)
+enum class MissPolicy {
+	BACKGROUND,
+	SKIP_NEXT,
+	ABORT,
+	DEGRADE
+};
+
+// Come assegnare i core dell'executive alle CPU (vedi Executive::set_core_placement)
+enum class CorePlacement {
+	IDENTITY,
+	CACHE_LOCAL
+};
+
+// Tempo di esecuzione osservato di un task rispetto al wcet dichiarato (vedi Executive::set_wcet_profiling)
+enum class WcetStatus {
+	UNMEASURED,  // nessun job misurato
+	OK,
+	NEAR,        // entro il wcet, ma non con il margine richiesto
+	OVER         // massimo osservato oltre il wcet
 };
 
 class Executive
@@ -22,9 +56,14 @@ class Executive
 		/* [INIT] Inizializza l'executive, impostando i parametri di scheduling:
 			num_tasks: numero totale di task presenti nello schedule;
 			frame_length: lunghezza del frame (in quanti temporali);
-			unit_duration: durata dell'unita di tempo, in millisecondi (default 10ms).
+			unit_duration: durata dell'unita di tempo, in millisecondi (default 10ms);
+			num_cores: numero di core su cui partizionare i task (default 1, il core i corrisponde alla CPU i,
+			           vedi set_core_placement).
 		*/
-		Executive(size_t num_tasks, unsigned int frame_length, unsigned int unit_duration = 10);
+		Executive(size_t num_tasks, unsigned int frame_length, unsigned int unit_duration = 10, unsigned int num_cores = 1);
+
+		/* Se l'applicazione è in esecuzione la ferma (stop() e wait()) */
+		~Executive();
 
 		/* [INIT] Imposta il task periodico di indice "task_id" (da invocare durante la creazione dello schedule):
 			task_id: indice progressivo del task, nel range [0, num_tasks);
@@ -33,50 +72,628 @@ class Executive
 		*/
 		void set_periodic_task(size_t task_id, std::function<void()> periodic_task, unsigned int wcet);
 
+		/* [INIT] Come set_periodic_task, con la funzione del task nota a tempo di compilazione
+		   (es. exec.set_periodic_task<task0>(0, 2)): il thread del task la invoca direttamente,
+		   senza passare da std::function. Usata da static_executive (static_schedule.h).
+		*/
+		template <void (*Function)()>
+		void set_periodic_task(size_t task_id, unsigned int wcet);
+
+		/* [INIT] Politica del task periodico "task_id" per i job che mancano la deadline (default BACKGROUND):
+				BACKGROUND: il job in ritardo prosegue a priorità minima; il rilascio successivo che lo trova
+				            ancora in corso viene differito e parte, con la priorità ripristinata, appena termina;
+				SKIP_NEXT: come BACKGROUND, ma i rilasci che trovano il job in ritardo vengono saltati;
+				ABORT: come BACKGROUND, e si chiede al job di terminare: la funzione del task deve controllare
+				       job_cancelled() e tornare appena possibile (il job viene contato come interrotto);
+				DEGRADE: come BACKGROUND, e i job successivi girano in modalità degradata (degraded_mode()
+				         restituisce true) finchè uno non termina entro la deadline.
+			Un rilascio differito che non parte entro il suo frame è un altro deadline miss e viene scartato.
+		*/
+		void set_miss_policy(size_t task_id, MissPolicy policy);
+
+		/* [RUN] Da invocare nella funzione di un task periodico: true se il job in corso deve terminare (ABORT) */
+		static bool job_cancelled();
+
+		/* [RUN] Da invocare nella funzione di un task periodico: true se il task è in modalità degradata (DEGRADE) */
+		static bool degraded_mode();
+
 		/* [INIT] Imposta il task aperiodico (da invocare durante la creazione dello schedule):
 			aperiodic_task: funzione da eseguire al rilascio del task;
 			wcet: tempo di esecuzione di caso peggiore (in quanti temporali).
+			Equivale ad add_aperiodic_task(aperiodic_task, wcet): il task ottiene l'id 0.
 		*/
 		void set_aperiodic_task(std::function<void()> aperiodic_task, unsigned int wcet);
 
+		/* [INIT] Aggiunge un task aperiodico o sporadico e ne restituisce l'id (0, 1, ...):
+			aperiodic_task: funzione da eseguire al rilascio del task;
+			wcet: tempo di esecuzione di caso peggiore (in quanti temporali);
+			deadline: deadline relativa, in frame: una richiesta arrivata nel frame n va completata entro
+			          la fine del frame n + deadline (al massimo max_ap_deadline);
+			min_interarrival: distanza minima tra due richieste (in frame), 0 = task aperiodico;
+			queue_size: numero massimo di richieste accettate in attesa (potenza di 2).
+			I job aperiodici girano (sul core 0) con priorità maggiore dei periodici finchè non hanno
+			consumato lo slack del frame (frame_length - somma dei wcet dei task del frame), poi con
+			priorità minima; tra loro in ordine di deadline.
+		*/
+		size_t add_aperiodic_task(std::function<void()> aperiodic_task, unsigned int wcet, unsigned int deadline = 1,
+		                          unsigned int min_interarrival = 0, size_t queue_size = 16);
+
+		static const unsigned int max_ap_deadline = 256;
+
+		/* [INIT] Assegna il task periodico "task_id" a un core (partizionamento statico, default core 0):
+			task_id: indice del task, nel range [0, num_tasks);
+			core: indice del core, nel range [0, num_cores).
+			Ogni core ha una propria tabella dei frame (ricavata da quelle passate ad add_frame
+			mantenendo l'ordine dei task) ed un proprio executive; il task aperiodico gira sul core 0.
+		*/
+		void set_task_core(size_t task_id, unsigned int core);
+
+		/* [INIT] Vincolo di precedenza tra due task periodici (da invocare durante la creazione dello schedule):
+			before, after: nei frame in cui compaiono entrambi, il job di "after" viene rilasciato solo quando
+			               è terminato quello di "before" (dal thread di "before", appena termina).
+			I task senza vincoli tra loro assegnati a core diversi (set_task_core) girano in parallelo: il frame
+			deve contenere il cammino critico, non la somma dei wcet. Se un predecessore non termina entro il
+			frame il task non viene rilasciato (deadline miss), e così i suoi successori. Un task compare al più
+			una volta per frame; i vincoli non formano cicli. Con l'esecuzione inline i due task devono stare
+			sullo stesso core, "before" prima di "after" nella tabella. simulate() non modella i vincoli.
+		*/
+		void add_precedence(size_t before, size_t after);
+
+		/* [INIT] Assegnamento dei core dell'executive alle CPU (default IDENTITY):
+			placement: IDENTITY: il core i è la CPU i;
+			           CACHE_LOCAL: num_cores CPU che condividono la cache L3 (se il sistema non la descrive,
+			           lo stesso nodo NUMA), una sola per core fisico: due core dell'executive non sono mai
+			           thread SMT fratelli, e i fratelli delle CPU scelte restano liberi dai suoi thread;
+			cpus: CPU tra cui scegliere (vuoto = affinità del thread che invoca start()).
+			La topologia viene letta da sysfs (rt/topology.h). Se nessun dominio di cache ha abbastanza core
+			fisici i core si distribuiscono su più domini, se i core fisici non bastano si usano anche i
+			fratelli SMT (con un avviso nel log). Executive, task periodici del core e task aperiodici (core 0)
+			girano sulla CPU del loro core.
+		*/
+		void set_core_placement(CorePlacement placement, const rt::affinity & cpus = rt::affinity());
+
+		/* [INIT] Imposta il timer dei frame (default: catch_up, nessuno spin):
+			policy: cosa fare se un frame sfora il suo confine (overrun):
+			        catch_up esegue comunque tutti i frame, in ritardo e uno dopo l'altro;
+			        skip salta i frame il cui inizio è già passato;
+			        realign riparte dall'inizio del prossimo ciclo della tabella dei frame (iperperiodo);
+			spin: anticipo del risveglio dopo cui l'executive attende il confine attivamente
+			      (riduce il jitter ai microsecondi, ma occupa la CPU per "spin" ad ogni frame).
+			Gli overrun e i frame saltati sono contati (get_frame_overruns, get_skipped_frames).
+		*/
+		void set_frame_timer(rt::frame_timer::overrun_policy policy,
+		                     std::chrono::microseconds spin = std::chrono::microseconds(0));
+
+		/* [INIT] Scheduling dei task periodici con SCHED_DEADLINE al posto della scala di priorità FIFO:
+			enable: ad ogni rilascio il thread del task riceve budget = wcet, deadline relativa = fine della
+			        sua posizione nel frame (somma dei wcet fino ad essa: l'EDF del kernel segue l'ordine
+			        della tabella, senza limiti sul numero di task) e periodo = distanza minima tra due suoi
+			        rilasci nella modalità; il kernel sospende il job che esaurisce il budget;
+			min_runtime: budget minimo (per wcet nulli o molto piccoli).
+			I parametri si cambiano solo quando differiscono da quelli del rilascio precedente. I task
+			SCHED_DEADLINE precedono ogni thread SCHED_FIFO: appena risvegliati interrompono l'executive e
+			i job aperiodici girano dopo i periodici del frame. Un job in ritardo non scende a priorità minima:
+			prosegue con il budget dei periodi successivi. Se il kernel rifiuta i parametri (admission control, permessi, affinità
+			ristretta a un core con più CPU) il task resta sulla scala FIFO e l'errore va nel log.
+		*/
+		void set_deadline_scheduling(bool enable, std::chrono::microseconds min_runtime = std::chrono::microseconds(100));
+
+		/* [INIT] Esecuzione inline dei task periodici (default false: un thread per task):
+			enable: l'executive di ogni core invoca direttamente, sul proprio stack e nell'ordine della tabella,
+			        le funzioni dei task del frame; non vengono creati thread per i task periodici (un solo
+			        thread per core, qualunque sia il numero di task) e rilascio e avvio non costano risvegli
+			        nè cambi di contesto.
+			Un job non può essere interrotto dal successivo: un timer scade alla fine del frame e segnala
+			l'overrun all'executive. Il job in corso termina comunque (con ABORT job_cancelled() diventa true),
+			conta come deadline miss e con DEGRADE i job successivi girano in modalità degradata; i task
+			del frame non ancora avviati vengono scartati (deadline miss). I job aperiodici girano dopo i
+			periodici del frame; SCHED_DEADLINE non si applica e i job di warm-up li esegue start().
+		*/
+		void set_inline_dispatch(bool enable);
+
 		/* [INIT] Lista di task da eseguire in un dato frame (da invocare durante la creazione dello schedule):
 			frame: lista degli id corrispondenti ai task da eseguire nel frame, in sequenza
 		*/
 		void add_frame(std::vector<size_t> frame);
 
-		/* [RUN] Lancia l'applicazione */
+		/* [INIT] Aggiunge una modalità: uno schedule alternativo, con nome, che si può attivare durante
+		   l'esecuzione con request_mode (la tabella di add_frame è la modalità "default", quella iniziale):
+			name: nome della modalità;
+			frames: tabella dei frame, come una sequenza di add_frame (stessa lunghezza del frame, anche
+			        un numero diverso di frame).
+			I task di tutte le modalità sono tra i num_tasks dell'executive: i loro thread vengono creati
+			da start(), anche se la modalità iniziale non li usa.
+		*/
+		void add_mode(const std::string & name, std::vector< std::vector<size_t> > frames);
+
+		/* [RUN] Richiede il passaggio alla modalità "name" (invocabile da qualunque thread, non blocca).
+			Il cambio avviene su tutti i core all'inizio dello stesso frame, il primo confine di iperperiodo
+			della modalità in corso dopo il frame in cui gli executive vedono la richiesta: i job del vecchio
+			schedule completano il loro iperperiodo, l'executive sostituisce solo il puntatore alla tabella.
+			Se lo slack già prenotato dai task aperiodici oltre quel confine non sta nello slack della nuova
+			modalità, il cambio slitta di un iperperiodo alla volta. Restituisce false se la modalità non
+			esiste, se l'executive non è avviato o se un altro cambio è ancora in attesa.
+		*/
+		bool request_mode(const std::string & name);
+
+		/* [INIT] Fase di warm-up eseguita da start() prima del primo frame (default: 64 KiB di stack, nessun job,
+		   memoria non bloccata):
+			stack_bytes: byte di stack pre-caricati (prefault) da ogni thread dei task e da ogni executive;
+			warmup_jobs: esecuzioni della funzione di ogni task (periodico e aperiodico) fuori dallo schedule e
+			             senza statistiche: scaldano cache e stato allocato pigramente, ma gli effetti dei task
+			             avvengono davvero;
+			lock_memory: blocca in RAM le pagine del processo man mano che vengono toccate (mlockall);
+			             se non è permesso viene segnalato e si prosegue.
+			Ogni thread prealloca anche il proprio ring di log. Terminato il warm-up, il frame 0 inizia al
+			primo multiplo della durata del frame (sul clock monotono) distante almeno un quanto.
+		*/
+		void set_warmup(size_t stack_bytes, unsigned int warmup_jobs = 0, bool lock_memory = false);
+
+		/* [INIT] Traccia binaria degli eventi di ogni esecuzione (default disattivata, vedi rt_trace.h):
+			path: file della traccia, riscritto ad ogni start() ("" = nessuna traccia);
+			events_per_thread: capacità del ring di ogni thread dei task (l'executive ne ha uno proporzionale
+			                   al numero di task del frame); gli eventi che non ci stanno vengono scartati.
+			Eventi: inizio dei frame, rilasci, avvio e fine dei job, cambi di priorità, deadline miss e
+			richieste aperiodiche, con istanti in ns. I ring si allocano durante il warm-up, un thread non
+			real-time li riversa nel file, che wait() completa e chiude. trace_convert lo converte in JSON
+			per chrome://tracing o Perfetto.
+		*/
+		void set_trace(const std::string & path, size_t events_per_thread = 256);
+
+		/* [INIT] Contatori di prestazioni dei job (default disattivati): ogni thread dei task (con l'esecuzione
+		   inline, l'executive di ogni core) apre con perf_event_open i contatori di cicli, istruzioni, miss della
+		   cache di ultimo livello e cambi di contesto del thread, e li legge prima e dopo ogni job (una system
+		   call per lettura). Le statistiche per task si leggono con get_task_perf / get_ap_task_perf.
+		   Disattivati costano un controllo per job; i contatori che il sistema non fornisce (VM senza PMU,
+		   perf_event_paranoid, permessi) restano non disponibili, come indica start() nel log.
+		*/
+		void set_perf_counters(bool enable);
+
+		/* [INIT] Profilo dei wcet (default disattivato): misura il tempo di CPU di ogni job dei task periodici e
+		   aperiodici (CLOCK_THREAD_CPUTIME_ID del thread che lo esegue: le preemption non contano, i job
+		   interrotti con ABORT non vengono registrati), per confrontarlo con il wcet dichiarato:
+			margin: fattore applicato al massimo osservato per il wcet suggerito (>= 1).
+		   Costa due letture del clock per job. I risultati si leggono con get_wcet_profile /
+		   get_frame_utilisation, e wait() li scrive nel log (log_wcet_report).
+		*/
+		void set_wcet_profiling(bool enable, double margin = 1.2);
+
+		/* [RUN] Lancia l'applicazione (dopo la fase di warm-up). Dopo il ritorno di wait() si può rilanciare:
+		   lo schedule riparte dal frame 0 della modalità "default", le statistiche si accumulano. */
 		void start();
 
-		/* [RUN] Attende (all'infinito) finchè gira l'applicazione */
-		void wait();
+		// riepilogo di un'esecuzione, da start() al ritorno di wait()
+		struct run_summary
+		{
+			uint64_t frames;          // frame trascorsi sul core 0, compresi quelli saltati
+			uint64_t overruns;        // confini di frame raggiunti in ritardo (tutti i core)
+			uint64_t skipped_frames;  // frame non eseguiti per la politica di overrun (tutti i core)
+			uint64_t jobs;            // job periodici completati (esclusi gli interrotti)
+			uint64_t misses;          // deadline miss dei task periodici
+			uint64_t skipped;         // rilasci saltati o scartati per un job in ritardo
+			uint64_t aborted;         // job interrotti (politica ABORT)
+			uint64_t ap_jobs;         // job aperiodici completati
+			uint64_t ap_accepted;
+			uint64_t ap_rejected;
+			uint64_t ap_misses;
+			uint64_t ap_dropped;      // richieste accettate ancora in coda alla fine, scartate
+			std::chrono::nanoseconds duration;    // inizio del frame 0 -> uscita degli executive
+			std::chrono::nanoseconds drain_time;  // uscita degli executive -> tutti i thread terminati
+		};
+
+		/* [RUN] Attende la fine dell'esecuzione (all'infinito, se nessuno invoca stop() e non è stato
+		   avviato con run_for): gli executive terminano l'ultimo frame, i job ancora in corso vengono
+		   completati (quelli in ritardo con la loro politica), i thread dei task terminano e vengono
+		   raccolti. Restituisce il riepilogo dell'esecuzione, che scrive anche nel log. Non va invocata
+		   da un task. */
+		run_summary wait();
+
+		/* [RUN] Esegue "frames" frame (dal frame 0, su ogni core) e termina: start() + wait() */
+		run_summary run_for(uint64_t frames);
+
+		/* [RUN] Richiede la fine dell'esecuzione al prossimo confine di frame (invocabile da qualunque
+		   thread, anche da un task, non blocca): il frame in corso viene completato, poi wait() ritorna. */
+		void stop();
+
+		/* [RUN] Richiede il rilascio del task aperiodico "ap_id" (invocabile da qualunque thread, non blocca).
+			Fuori dall'esecuzione (prima di start() o dopo wait()) la richiesta viene rifiutata.
+			Test di accettazione: la richiesta viene accettata solo se nei frame entro la sua deadline
+			resta abbastanza slack non ancora riservato per il suo wcet (che viene allora riservato),
+			se la coda del task non è piena e, per i task sporadici, se è rispettata la distanza minima.
+			Restituisce false se la richiesta è stata rifiutata (mai scartata silenziosamente).
+		*/
+		bool ap_task_request(size_t ap_id = 0);
+
+		/* [SIM] Tempo di esecuzione dei job del task periodico "task_id" nella simulazione:
+				exec_time: restituisce la durata (in quanti temporali) di ogni nuovo job; default il wcet.
+		*/
+		void set_sim_exec_time(size_t task_id, std::function<double()> exec_time);
+
+		/* [SIM] Come set_sim_exec_time, per il task aperiodico "ap_id" */
+		void set_sim_ap_exec_time(size_t ap_id, std::function<double()> exec_time);
+
+		/* [SIM] Arrivi delle richieste del task aperiodico "ap_id" nella simulazione:
+				interarrival: restituisce il tempo (in quanti) fino alla prossima richiesta (la prima arriva
+				              dopo interarrival() dall'inizio); senza arrivi il task non viene mai richiesto.
+		*/
+		void set_sim_ap_arrivals(size_t ap_id, std::function<double()> interarrival);
+
+		/* [SIM] Esegue "num_frames" frame di ogni core in tempo virtuale, al posto di start()/wait():
+			nessun thread nè attesa reale, le funzioni dei task non vengono invocate e ogni job dura quanto
+			indicato da set_sim_exec_time. La logica è quella dell'executive (rilasci, priorità, slack dei
+			task aperiodici, test di accettazione, deadline miss) su uno scheduler a priorità fissa preemptive
+			simulato per core. Le statistiche si leggono al termine con get_task_stats / get_ap_task_stats
+			(tempi in ns virtuali). Si può invocare una sola volta, e non insieme a start().
+			Simula solo la modalità iniziale (le altre di add_mode non vengono mai attivate) e i thread dei
+			task sulla scala SCHED_FIFO: non si può usare con set_inline_dispatch nè con set_deadline_scheduling.
+		*/
+		void simulate(uint64_t num_frames);
+
+		/* Statistiche temporali di un task (tempi in nanosecondi, riferiti all'istante nominale di rilascio,
+		   cioè l'inizio del frame in cui il job viene rilasciato). */
+		struct task_stats
+		{
+			histogram_snapshot release_jitter;  // avvio del job - rilascio
+			histogram_snapshot response_time;   // completamento del job - rilascio
+			uint64_t misses;                    // deadline miss rilevate
+			uint64_t accepted;                  // richieste accettate (solo task aperiodici)
+			uint64_t rejected;                  // richieste rifiutate (solo task aperiodici)
+			uint64_t skipped;                   // rilasci saltati o scartati per un job in ritardo (solo periodici)
+			uint64_t aborted;                   // job interrotti su richiesta (politica ABORT)
+		};
+
+		/* [STAT] Statistiche del task periodico "task_id" (invocabile durante l'esecuzione, non blocca lo schedule) */
+		task_stats get_task_stats(size_t task_id) const;
 
-		/* [RUN] Richiede il rilascio del task aperiodico (da invocare durante l'esecuzione).*/
-		void ap_task_request();
+		/* [STAT] Statistiche del task aperiodico "ap_id" (tempi riferiti all'arrivo della richiesta) */
+		task_stats get_ap_task_stats(size_t ap_id = 0) const;
+
+		// contatori di prestazioni dei job di un task (set_perf_counters), 0 se non disponibili
+		struct perf_stats
+		{
+			bool available[rt::perf_counters::num_counters];  // indici: rt::perf_counters::counter
+			uint64_t jobs;                                     // job misurati
+			uint64_t total[rt::perf_counters::num_counters];   // somma sui job
+			uint64_t max[rt::perf_counters::num_counters];     // massimo di un singolo job
+			uint64_t slowest[rt::perf_counters::num_counters]; // job di durata massima (avvio -> fine)
+			std::chrono::nanoseconds slowest_time;             // durata di quel job
+		};
+
+		/* [STAT] Contatori dei job del task periodico "task_id" (invocabile durante l'esecuzione) */
+		perf_stats get_task_perf(size_t task_id) const;
+
+		/* [STAT] Contatori dei job del task aperiodico "ap_id" */
+		perf_stats get_ap_task_perf(size_t ap_id = 0) const;
+
+		// tempo di CPU dei job di un task rispetto al wcet dichiarato (set_wcet_profiling)
+		struct wcet_profile
+		{
+			unsigned int wcet;             // dichiarato (quanti)
+			histogram_snapshot exec_time;  // tempo di CPU dei job (ns)
+			double max_units;              // massimo osservato, in quanti
+			unsigned int suggested;        // massimo * margine arrotondato per eccesso, almeno 1 (0 senza misure)
+			WcetStatus status;
+		};
+
+		/* [STAT] Profilo del task periodico "task_id" (invocabile durante l'esecuzione) */
+		wcet_profile get_wcet_profile(size_t task_id) const;
+
+		/* [STAT] Profilo del task aperiodico "ap_id" */
+		wcet_profile get_ap_wcet_profile(size_t ap_id = 0) const;
+
+		// carico di un frame della tabella di un core (quanti, l'utilizzo è il rapporto con frame_length)
+		struct frame_utilisation
+		{
+			unsigned int core;
+			size_t frame;
+			unsigned int declared;   // somma dei wcet dichiarati dei task del frame
+			double observed;         // somma dei massimi osservati (dei task senza misure, il wcet dichiarato)
+			unsigned int suggested;  // somma dei wcet suggeriti (dei task senza misure, il wcet dichiarato)
+		};
+
+		/* [STAT] Carico di ogni frame della modalità "mode", core per core (dopo start()), per stringere o
+		   ribilanciare la tabella dei frame con i tempi osservati */
+		std::vector<frame_utilisation> get_frame_utilisation(const std::string & mode = "default") const;
+
+		/* [STAT] Scrive nel log il profilo di ogni task (wcet suggerito, avviso per quelli NEAR e OVER) e
+		   l'utilizzo di ogni frame della modalità "mode" */
+		void log_wcet_report(const std::string & mode = "default") const;
+
+		/* [STAT] Ritardo dell'executive del core "core" rispetto all'inizio nominale di ogni frame (ns) */
+		histogram_snapshot get_frame_lateness(unsigned int core = 0) const;
+
+		/* [STAT] Tempo di CPU consumato dall'executive del core "core" in ogni frame (ns) */
+		histogram_snapshot get_dispatcher_cpu_time(unsigned int core = 0) const;
+
+		/* [STAT] Numero di confini di frame raggiunti in ritardo dall'executive del core "core",
+		   e numero di frame non eseguiti per effetto della politica di overrun */
+		uint64_t get_frame_overruns(unsigned int core = 0) const;
+		uint64_t get_skipped_frames(unsigned int core = 0) const;
+
+		// costo dell'avvio (vedi set_warmup)
+		struct startup_report
+		{
+			bool memory_locked;
+			std::chrono::nanoseconds lock_time;    // mlockall
+			std::chrono::nanoseconds warmup_time;  // creazione dei thread, prefault degli stack e job di warm-up
+			std::chrono::nanoseconds start_delay;  // fine del warm-up -> inizio del frame 0 (allineato)
+		};
+
+		/* [STAT] Costo dell'avvio (disponibile al ritorno di start(), che lo scrive anche nel log) */
+		startup_report get_startup_report() const;
+
+		/* [STAT] CPU assegnata al core "core" (vedi set_core_placement; definitiva dal primo start()) */
+		size_t get_core_cpu(unsigned int core = 0) const;
+
+		/* [STAT] Nome della modalità in corso */
+		const std::string & get_mode() const;
+
+		/* [STAT] Ritardo dei cambi di modalità: richiesta -> inizio del primo frame della nuova modalità (ns) */
+		histogram_snapshot get_mode_switch_latency() const;
 
 	private:
+		// contatori di prestazioni accumulati da un task (scritti solo dal thread che esegue i suoi job)
+		struct perf_record
+		{
+			perf_record();
+
+			std::unique_ptr<rt::perf_counters> counters;  // del thread del task, aperti nel warm-up
+			std::atomic<bool> available[rt::perf_counters::num_counters];
+			std::atomic<uint64_t> jobs;
+			std::atomic<uint64_t> total[rt::perf_counters::num_counters];
+			std::atomic<uint64_t> max[rt::perf_counters::num_counters];
+			std::atomic<uint64_t> slowest[rt::perf_counters::num_counters];
+			std::atomic<int64_t> slowest_time;
+		};
+
+		// contatori e istante all'avvio di un job
+		struct perf_sample
+		{
+			rt::perf_counters::sample counters;
+			int64_t time;
+		};
+
 		struct task_data
 		{
 			std::function<void()> function;
 			unsigned int wcet;
 			std::thread thread;
-			std::mutex mtx;
-			std::condition_variable cv;
-			std::condition_variable cv_done;
-			TaskState state = TaskState::IDLE;      // nuovo stato del task		
+			std::atomic<int> state{static_cast<int>(TaskState::IDLE)};  // TaskState, usata anche come parola futex
+			std::atomic<int64_t> release_time{0};  // istante nominale di rilascio dell'ultimo job (ns)
+			latency_histogram release_jitter;
+			latency_histogram response_time;
+			std::atomic<uint64_t> misses{0};
+			unsigned int core = 0;                  // core a cui è assegnato il task
+			std::function<double()> sim_exec_time;  // durata dei job nella simulazione (quanti), vuota = wcet
+			MissPolicy miss_policy = MissPolicy::BACKGROUND;
+			rt::priority priority;                  // priorità dell'ultimo rilascio, ripristinata dopo un ritardo
+			rt::deadline_params deadline;           // parametri SCHED_DEADLINE dell'ultimo rilascio (runtime 0 = scala FIFO)
+			rt::cached_priority thread_prio;        // priorità attuale del thread (salta le system call inutili)
+			std::atomic<bool> deadline_refused{false};  // SCHED_DEADLINE rifiutato dal kernel: resta sulla scala FIFO
+			bool released = false;                  // rilasciato nel frame in corso (solo executive)
+			std::atomic<bool> cancelled{false};     // richiesta di terminazione del job (ABORT)
+			std::atomic<bool> degraded{false};      // modalità degradata (DEGRADE)
+			std::atomic<uint64_t> skipped{0};
+			std::atomic<uint64_t> aborted{0};
+			void (Executive::*thread_function)(task_data &) = nullptr;  // ciclo del thread, nullptr = function_job
+			void (*job)(task_data &) = nullptr;  // corpo del job per l'esecuzione inline, nullptr = function_job
+			std::vector<size_t> successors;         // task che attendono la fine dei suoi job (add_precedence)
+			// predecessori arrivati per il job del frame assoluto f, (f << 16) | arrivi (vedi precedence_arrive)
+			std::atomic<uint64_t> precedence{0};
+			uint32_t trace_id = 0;  // id negli eventi della traccia (task aperiodici: id | rttrace::ap_flag)
+			std::unique_ptr<perf_record> perf;  // contatori dei job (set_perf_counters), nullptr = disattivati
+			std::unique_ptr<latency_histogram> exec_time;  // tempo di CPU dei job (set_wcet_profiling), nullptr = disattivato
+		};
+
+		// richiesta accettata di un task aperiodico
+		struct ap_request
+		{
+			int64_t arrival;          // istante della richiesta (ns)
+			uint64_t first_frame;     // primo frame (assoluto) in cui il job può partire
+			uint64_t deadline_frame;  // il job deve terminare prima dell'inizio di questo frame (assoluto)
+		};
+
+		struct ap_task_data : task_data
+		{
+			explicit ap_task_data(size_t queue_size) : requests(queue_size) {}
+
+			size_t id;
+			unsigned int deadline;             // in frame
+			unsigned int min_interarrival;     // in frame, 0 = aperiodico
+			mpsc_queue<ap_request> requests;
+			std::atomic<int64_t> last_arrival{INT64_MIN / 2};
+			std::atomic<size_t> queued{0};     // richieste accettate non ancora estratte dalla coda
+			std::atomic<uint64_t> accepted{0};
+			std::atomic<uint64_t> rejected{0};
+			std::atomic<uint64_t> deadline_frame{0};  // deadline del job in corso
+			std::atomic<uint64_t> missed_frame{0};    // deadline dell'ultimo job già contato come miss
+			uint64_t sort_deadline = 0;               // chiave di ordinamento (solo executive)
+			std::function<double()> sim_interarrival;  // arrivi delle richieste nella simulazione (quanti)
+		};
+
+		struct sim_thread;  // thread di un task nella simulazione (simulation.cpp)
+
+		// tabella dei frame di un core in una modalità (non cambia dopo prepare)
+		struct core_table
+		{
+			// tabella piatta: il frame f è formato dalle posizioni [frame_begin[f], frame_begin[f + 1])
+			std::vector<size_t> tasks;
+			std::vector<rt::priority> priorities;  // priorità di rilascio di ogni posizione
+			std::vector<rt::deadline_params> deadlines;  // parametri SCHED_DEADLINE di ogni posizione (se abilitato)
+			std::vector<unsigned int> predecessors;  // predecessori presenti nel frame (tutti i core) di ogni posizione
+			std::vector<size_t> frame_begin;
+			std::vector<unsigned int> slack;  // quanti liberi di ogni frame (frame_length - somma dei wcet)
+		};
+
+		// schedule con nome: tabella dei frame e sua partizione sui core
+		struct mode_data
+		{
+			std::string name;
+			std::vector< std::vector<size_t> > frames;
+			std::vector<core_table> cores;
+		};
+
+		// dati di un core: executive che esegue la tabella della modalità in corso
+		struct core_data
+		{
+			std::thread exec_thread;
+			size_t cpu = 0;       // CPU del core (set_core_placement)
+			size_t frame_id = 0;  // frame della tabella in corso
+			std::vector<task_data *> woken;             // task rilasciati nel frame, da risvegliare (solo executive)
+			std::vector<rt::cached_priority *> demoted;  // thread da declassare a fine frame (solo executive)
+			latency_histogram frame_lateness;
+			latency_histogram dispatch_cpu;
+			std::unique_ptr<rt::frame_timer> timer;
+			std::atomic<task_data *> inline_task{nullptr};  // job in esecuzione inline (letto dal signal handler)
 		};
 
-		size_t frame_id = 0;
 		std::vector<task_data> p_tasks;
-		task_data ap_task;
-		bool ap_task_set = false;
-		bool ap_task_requested_this_frame = false;  //serve per bloccare richieste multiple nello stesso frame
-		std::thread exec_thread;
-		std::vector< std::vector<size_t> > frames;
+		std::vector<core_data> cores;
+		std::vector< std::unique_ptr<ap_task_data> > ap_tasks;
+		std::atomic<uint64_t> ap_frame{0};  // frame assoluto in corso sul core 0 (quello dei task aperiodici)
+		// slack riservato dalle richieste accettate: per ogni frame assoluto k la cella k % max_ap_deadline
+		// contiene (k << 16) | quanti riservati, così una cella di un frame passato vale come vuota
+		std::atomic<uint64_t> reserved_slack[max_ap_deadline];
+		std::vector<ap_task_data *> ap_active;  // job aperiodici attivi nel frame, in ordine di deadline
+		std::vector<mode_data> modes;  // modes[0] è "default" (add_frame)
+		// modalità in corso e frame assoluto in cui è iniziata, (modalità << 48) | frame
+		std::atomic<uint64_t> mode_state{0};
+		// cambio di modalità in attesa, ((modalità + 1) << 48) | frame assoluto del cambio (0 finchè un executive
+		// non lo fissa, vedi fix_mode_request); 0 = nessuno
+		std::atomic<uint64_t> mode_request{0};
+		std::atomic<bool> mode_busy{false};          // richiesta accettata, non ancora applicata da tutti i core
+		std::atomic<int64_t> mode_request_time{0};
+		std::atomic<unsigned int> mode_switched{0};  // core che hanno già applicato il cambio
+		latency_histogram mode_latency;
 		const unsigned int frame_length;			// lunghezza del frame (in quanti temporali)
 		const std::chrono::milliseconds unit_time;  // durata dell'unita di tempo (quanto temporale)
+		std::chrono::steady_clock::time_point start_time;  // inizio del frame 0, comune a tutti i core
+		rt::frame_timer::overrun_policy overrun_policy = rt::frame_timer::catch_up;
+		std::chrono::microseconds timer_spin{0};
+		bool use_deadline = false;
+		std::chrono::nanoseconds deadline_min_runtime{0};
+		bool inline_dispatch = false;
+		CorePlacement placement = CorePlacement::IDENTITY;
+		rt::affinity placement_cpus;
+		size_t warmup_stack = 64 * 1024;
+		unsigned int warmup_jobs = 0;
+		bool warmup_lock = false;
+		std::string trace_path;
+		size_t trace_events = 256;
+		bool perf_enabled = false;
+		bool wcet_profiling = false;
+		double wcet_margin = 1.2;
+		std::atomic<int> warming{0};  // thread dei task che non hanno ancora finito il warm-up
+		startup_report startup{};
+
+		bool started = false;  // tabelle dei frame preparate, configurazione bloccata
+		std::atomic<bool> running{false};  // da start() alla fine di wait()
+		std::atomic<uint64_t> stop_frame{UINT64_MAX};  // gli executive escono al confine di questo frame
+		run_summary run_base{};  // contatori cumulativi all'avvio (il riepilogo è la differenza)
+
+		static rt::priority ap_priority();
+
+		void place_cores();  // sceglie la CPU di ogni core (prepare)
+		void prepare();  // partiziona la tabella dei frame sui core e calcola lo slack (start/simulate)
+		uint64_t clock_frame() const;  // frame assoluto in corso secondo il clock (0 prima del frame 0)
+		run_summary totals() const;    // contatori cumulativi di job e richieste (solo i campi dei task)
+		void stop_tasks(run_summary & summary);  // completa i job in corso e termina i thread dei task
+		void reset_run();  // riporta lo stato di esecuzione a quello iniziale, per un nuovo start()
+
+		static TaskState get_state(const task_data & task);
+		static bool change_state(task_data & task, TaskState from, TaskState to);
+		static bool release(task_data & task);  // READY + risveglio via futex, solo da IDLE/DONE
+		// priorità del thread per il job rilasciato: parametri SCHED_DEADLINE se il task li ha, altrimenti la scala FIFO
+		static bool uses_deadline(const task_data & task);
+		static void set_release_priority(task_data & task);
+		// rilascio di un task periodico secondo la sua MissPolicy (solo transizioni di stato e contatori:
+		// priority e release_time vanno impostati prima, priorità del thread e risveglio dopo)
+		enum release_outcome { RELEASED, DEFERRED, SKIPPED };
+		static release_outcome release_periodic(task_data & task);
+		// a fine frame, per un task rilasciato (o differito) nel frame: MISSED se il job è stato scartato,
+		// NOW_LATE se prosegue in ritardo (il thread va declassato)
+		enum miss_outcome { ON_TIME, MISSED, NOW_LATE };
+		static miss_outcome check_periodic_miss(task_data & task);
+		// vincoli di precedenza: il task del frame assoluto "frame" si rilascia quando arrivano l'executive
+		// (con "arrivals" = precedence_armed - predecessori) e i predecessori (1 ciascuno); true per l'ultimo arrivo
+		static bool precedence_arrive(task_data & task, uint64_t frame, unsigned int arrivals);
+		static bool precedence_cancel(task_data & task, uint64_t frame);  // fine frame: true se era ancora in attesa
+		void release_successors(task_data & task, int64_t release_time);  // nel thread del task, a fine job
+		void release_held(task_data & task, uint64_t frame);  // rilascio di un task che attendeva i predecessori
 
-		static void task_function(task_data & task);
-		void exec_function();
+		// slack del core 0 nel frame assoluto "frame", secondo la modalità in corso o quella richiesta
+		unsigned int slack_of(uint64_t frame) const;
+		// slack del core 0 nel frame assoluto "frame" con la modalità "state" e il cambio "request" (valori di mode_state/mode_request)
+		unsigned int slack_under(uint64_t request, uint64_t state, uint64_t frame) const;
+		// fissa il frame del cambio richiesto da request_mode (executive al frame "frame"), restituisce la richiesta fissata
+		uint64_t fix_mode_request(uint64_t request, uint64_t frame);
+		// true se lo slack prenotato sta in quello dei frame dopo il cambio "request"
+		bool reservations_fit(uint64_t request) const;
+		// riserva "units" quanti di slack nei frame [first_frame, end_frame) del core 0, "taken" riceve quanti per frame
+		bool reserve_slack(uint64_t first_frame, uint64_t end_frame, unsigned int units, unsigned int * taken);
+		void unreserve_slack(uint64_t first_frame, uint64_t end_frame, const unsigned int * taken);
+		// test di accettazione di una richiesta arrivata all'istante "arrival" (ns) durante il frame assoluto "frame"
+		bool admit_ap_request(ap_task_data & ap, int64_t arrival, uint64_t frame);
+
+		// corpo di un job: la std::function del task o una funzione nota a tempo di compilazione
+		struct function_job { static void run(task_data & task) { task.function(); } };
+		template <void (*Function)()>
+		struct direct_job { static void run(task_data &) { Function(); } };
+
+		void warm_up(task_data & task, void (*job)(task_data &));  // nel thread del task, prima del primo frame
+		// attende il rilascio e avvia il job, il cui istante di rilascio va in "release_time" (false: STOPPED)
+		static bool wait_release(task_data & task, int64_t & release_time);
+		static int64_t begin_job(task_data & task);
+		// chiude il job: true se parte subito il rilascio differito (il cui istante va in "release_time")
+		static bool end_job(task_data & task, int64_t & release_time);
+		template <typename Job>
+		void task_function(task_data & task);
+		void ap_task_function(ap_task_data & ap);
+		static bool count_ap_miss(ap_task_data & ap, uint64_t deadline_frame);
+		// contatori attorno a un job: "counters" sono quelli del thread che lo esegue
+		static void mark_available(perf_record & record, const rt::perf_counters & counters);
+		static void begin_perf(const rt::perf_counters & counters, perf_sample & sample);
+		static void end_perf(perf_record & record, const rt::perf_counters & counters, const perf_sample & sample);
+		static perf_stats perf_snapshot(const perf_record * record);
+		wcet_profile profile_of(const task_data & task) const;
+		static void record_exec_time(task_data & task, std::chrono::nanoseconds cpu_begin);  // a fine job, se non interrotto
+		// esecuzione inline dei task del frame "frame_id" (nell'executive); "overrun" (se c'è) scade alla fine del frame,
+		// "perf" sono i contatori dell'executive (se set_perf_counters)
+		void dispatch_inline(size_t core, const core_table & table, size_t frame_id, rt::alarm * overrun,
+		                     const rt::perf_counters * perf);
+		static void inline_overrun(void * core);  // signal handler del timer di fine frame
+		void exec_function(size_t core);
 };
 
+// ciclo del thread di un task periodico (template: il corpo del job può essere una chiamata diretta)
+template <typename Job>
+void Executive::task_function(Executive::task_data & task)
+{
+	warm_up(task, &Job::run);
+
+	int64_t release_time;
+	while (wait_release(task, release_time)) {
+		do {
+			perf_sample sample;
+			if (task.perf)
+				begin_perf(*task.perf->counters, sample);
+			const auto cpu_begin = task.exec_time ? rt::thread_cpu_time() : std::chrono::nanoseconds(0);
+			Job::run(task);
+			if (task.exec_time)
+				record_exec_time(task, cpu_begin);
+			if (task.perf)
+				end_perf(*task.perf, *task.perf->counters, sample);
+			release_successors(task, release_time);
+		} while (end_job(task, release_time));
+	}
+}
+
+template <void (*Function)()>
+void Executive::set_periodic_task(size_t task_id, unsigned int wcet)
+{
+	set_periodic_task(task_id, Function, wcet);  // la std::function serve solo al controllo in start()
+	p_tasks[task_id].thread_function = &Executive::task_function< direct_job<Function> >;
+	p_tasks[task_id].job = &direct_job<Function>::run;
+}
+
 #endif
@@ -0,0 +1,87 @@
+#include "histogram.h"
+
+#include <algorithm>
+
+latency_histogram::latency_histogram() : count(0), sum(0), max(0)
+{
+	for (auto & b: buckets)
+		b.store(0, std::memory_order_relaxed);
+}
+
+size_t latency_histogram::bucket_of(uint64_t value)
+{
+	const uint64_t sub = 1 << sub_bits;
+
+	if (value < sub)
+		return value;
+
+	unsigned int msb = 63 - __builtin_clzll(value);
+	if (msb >= max_bits)
+		return num_buckets - 1;
+
+	return ((msb - sub_bits + 1) << sub_bits) + ((value >> (msb - sub_bits)) & (sub - 1));
+}
+
+uint64_t latency_histogram::bucket_upper(size_t bucket)
+{
+	const uint64_t sub = 1 << sub_bits;
+
+	if (bucket < sub)
+		return bucket;
+
+	uint64_t group = bucket >> sub_bits;
+	uint64_t lower = (sub + (bucket & (sub - 1))) << (group - 1);
+	return lower + (uint64_t(1) << (group - 1)) - 1;
+}
+
+void latency_histogram::record(uint64_t value)
+{
+	buckets[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+	sum.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t old_max = max.load(std::memory_order_relaxed);
+	while (value > old_max && !max.compare_exchange_weak(old_max, value, std::memory_order_relaxed))
+		;
+
+	count.fetch_add(1, std::memory_order_release);
+}
+
+histogram_snapshot latency_histogram::snapshot() const
+{
+	histogram_snapshot s;
+
+	s.count = count.load(std::memory_order_acquire);
+	s.sum = sum.load(std::memory_order_relaxed);
+	s.max = max.load(std::memory_order_relaxed);
+	s.buckets.resize(num_buckets);
+	for (size_t i = 0; i < num_buckets; ++i)
+		s.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+
+	return s;
+}
+
+uint64_t histogram_snapshot::percentile(double p) const
+{
+	uint64_t total = 0;
+	for (auto b: buckets)
+		total += b;
+	if (total == 0)
+		return 0;
+
+	// rank del campione cercato (1-based), calcolato sui bucket: il contatore "count" può essere già avanzato
+	uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p * total + 0.5));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < buckets.size(); ++i)
+	{
+		seen += buckets[i];
+		if (seen >= rank)
+			return std::min(latency_histogram::bucket_upper(i), max);
+	}
+
+	return max;
+}
+
+double histogram_snapshot::mean() const
+{
+	return count ? static_cast<double>(sum) / count : 0.0;
+}
@@ -0,0 +1,47 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Copia (non atomica) del contenuto di un istogramma, su cui calcolare le statistiche. */
+struct histogram_snapshot
+{
+	uint64_t count = 0;
+	uint64_t sum = 0;
+	uint64_t max = 0;
+	std::vector<uint64_t> buckets;
+
+	/* valore sotto cui cade la frazione "p" (in [0,1]) dei campioni; errore relativo <= 1/8 */
+	uint64_t percentile(double p) const;
+	double mean() const;
+};
+
+/* Istogramma a bucket logaritmici (8 sotto-bucket per potenza di 2), preallocato e lock-free:
+   record() può essere invocata da qualunque thread, snapshot() non blocca chi registra.
+   I campioni oltre 2^40 (in ns circa 18 minuti) finiscono nell'ultimo bucket. */
+class latency_histogram
+{
+	public:
+		static const unsigned int sub_bits = 3;
+		static const unsigned int max_bits = 40;
+		static const size_t num_buckets = (max_bits - sub_bits + 1) << sub_bits;
+
+		latency_histogram();
+
+		void record(uint64_t value);
+		histogram_snapshot snapshot() const;
+
+		static size_t bucket_of(uint64_t value);
+		static uint64_t bucket_upper(size_t bucket);  // massimo valore contenuto nel bucket
+
+	private:
+		std::atomic<uint64_t> buckets[num_buckets];
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> sum;
+		std::atomic<uint64_t> max;
+};
+
+#endif
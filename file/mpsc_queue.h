@@ -0,0 +1,85 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/* Coda limitata lock-free a più produttori e un solo consumatore (schema di D. Vyukov):
+   push() è invocabile da qualunque thread e fallisce (senza bloccare) se la coda è piena,
+   pop() va invocata sempre dallo stesso thread. La capacità deve essere una potenza di 2. */
+template <typename T>
+class mpsc_queue
+{
+	public:
+		explicit mpsc_queue(size_t capacity) : cells(new cell[capacity]), mask(capacity - 1), tail(0), head(0)
+		{
+			assert(capacity > 0 && (capacity & mask) == 0);
+			for (size_t i = 0; i < capacity; ++i)
+				cells[i].seq.store(i, std::memory_order_relaxed);
+		}
+
+		bool push(const T & value)
+		{
+			size_t pos = tail.load(std::memory_order_relaxed);
+			while (true)
+			{
+				cell & c = cells[pos & mask];
+				size_t seq = c.seq.load(std::memory_order_acquire);
+				intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+				if (diff == 0)
+				{
+					if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						c.value = value;
+						c.seq.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0)
+					return false;  // piena
+				else
+					pos = tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		bool pop(T & value)
+		{
+			if (!front(value))
+				return false;
+
+			cells[head & mask].seq.store(head + mask + 1, std::memory_order_release);
+			++head;
+			return true;
+		}
+
+		// legge il primo elemento senza estrarlo (solo dal consumatore)
+		bool front(T & value) const
+		{
+			const cell & c = cells[head & mask];
+			if (c.seq.load(std::memory_order_acquire) != head + 1)
+				return false;  // vuota (o elemento non ancora pubblicato)
+
+			value = c.value;
+			return true;
+		}
+
+		size_t capacity() const { return mask + 1; }
+
+	private:
+		struct cell
+		{
+			std::atomic<size_t> seq;
+			T value;
+		};
+
+		std::unique_ptr<cell[]> cells;
+		const size_t mask;
+		std::atomic<size_t> tail;  // prossima posizione di inserimento (produttori)
+		size_t head;               // prossima posizione di estrazione (consumatore)
+};
+
+#endif
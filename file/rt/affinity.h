@@ -2,12 +2,56 @@
 #define RT_AFFINITY_H
 
 #include <thread>
-#include <bitset>
+#include <vector>
+#include <string>
+#include <cstdint>
 
 namespace rt
 {
 
-typedef std::bitset<32> affinity;
+// CPUs configured in the system (online or not): the size of every affinity
+size_t cpu_count();
+
+// set of CPUs, sized at run time from cpu_count() (cpu_set_t allocated with CPU_ALLOC)
+class affinity
+{
+	public:
+		affinity();  // empty
+		explicit affinity(unsigned long long mask);  // CPUs 0..63 from a bit mask
+
+		static affinity single(size_t cpu);
+		static affinity parse(const std::string & list);  // kernel cpu list, e.g. "0-3,8,10-11"
+
+		size_t size() const { return bits; }
+		size_t count() const;
+		bool any() const;
+		bool none() const { return !any(); }
+
+		bool test(size_t cpu) const { return cpu < bits && (words[cpu / 64] >> (cpu % 64)) & 1; }
+		bool operator [](size_t cpu) const { return test(cpu); }
+		affinity & set();
+		affinity & set(size_t cpu, bool value = true);
+		affinity & reset(size_t cpu) { return set(cpu, false); }
+
+		// first CPU of the set from "cpu" on (size() if none)
+		size_t next(size_t cpu = 0) const;
+
+		affinity & operator &=(const affinity & a);
+		affinity & operator |=(const affinity & a);
+		affinity & operator -=(const affinity & a);  // removes the CPUs of "a"
+		bool operator ==(const affinity & a) const { return words == a.words; }
+		bool operator !=(const affinity & a) const { return words != a.words; }
+
+		std::string to_string() const;  // kernel cpu list
+
+	private:
+		size_t bits;
+		std::vector<uint64_t> words;
+};
+
+inline affinity operator &(affinity a, const affinity & b) { return a &= b; }
+inline affinity operator |(affinity a, const affinity & b) { return a |= b; }
+inline affinity operator -(affinity a, const affinity & b) { return a -= b; }
 
 affinity get_affinity(const std::thread & th);
 void set_affinity(std::thread & th, const affinity & a);
@@ -21,4 +65,3 @@ void set_affinity(const affinity & a);
 }
 
 #endif
-
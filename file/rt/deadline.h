@@ -0,0 +1,55 @@
+#ifndef RT_DEADLINE_H
+#define RT_DEADLINE_H
+
+#include <chrono>
+
+namespace rt
+{
+
+// SCHED_DEADLINE (Linux): the thread may run for "runtime" in each "period", and must do so within
+// "deadline" of the activation; the kernel enforces the budget (the thread is throttled when it is used up)
+// and orders runnable threads by absolute deadline (EDF), above every SCHED_FIFO thread.
+// Constraints: 1024 ns <= runtime <= deadline <= period <= max_deadline_period(); the total bandwidth
+// (runtime / period) of the deadline threads is subject to the kernel admission control.
+struct deadline_params
+{
+	std::chrono::nanoseconds runtime{0};
+	std::chrono::nanoseconds deadline{0};
+	std::chrono::nanoseconds period{0};
+
+	bool operator ==(const deadline_params & p) const;
+	bool operator !=(const deadline_params & p) const;
+};
+
+// kernel thread id: SCHED_DEADLINE has no pthread interface, threads are addressed by tid
+typedef int tid_t;
+
+const std::chrono::nanoseconds min_deadline_runtime(1024);
+
+// longest period accepted by the kernel (kernel.sched_deadline_period_max_us, 4.19 s by default)
+std::chrono::nanoseconds max_deadline_period();
+
+void set_deadline(tid_t tid, const deadline_params & p); // throw (permission_error)
+
+namespace this_thread
+{
+tid_t tid();
+
+void set_deadline(const deadline_params & p); // throw (permission_error)
+}
+
+// ...............................................................................................
+
+inline bool deadline_params::operator ==(const deadline_params & p) const
+{
+	return runtime == p.runtime && deadline == p.deadline && period == p.period;
+}
+
+inline bool deadline_params::operator !=(const deadline_params & p) const
+{
+	return !(*this == p);
+}
+
+}
+
+#endif
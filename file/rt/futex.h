@@ -0,0 +1,17 @@
+#ifndef RT_FUTEX_H
+#define RT_FUTEX_H
+
+#include <atomic>
+
+namespace rt
+{
+
+// blocks the calling thread while "word" holds "expected" (may return spuriously)
+void futex_wait(std::atomic<int> & word, int expected);
+
+// wakes up to "count" threads blocked on "word"
+void futex_wake(std::atomic<int> & word, int count = 1);
+
+}
+
+#endif
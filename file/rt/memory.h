@@ -0,0 +1,20 @@
+#ifndef RT_MEMORY_H
+#define RT_MEMORY_H
+
+#include <cstddef>
+
+namespace rt
+{
+
+// locks the pages of the process in RAM (mlockall) and keeps the heap from being returned to the
+// system; with on_fault pages are locked as they are touched, instead of all at once (including
+// the whole reserved stack of every thread)
+void lock_memory(bool on_fault = false); // throw (permission_error)
+
+// touches "bytes" of the calling thread's stack below the current frame, so that they are
+// mapped before the thread enters its real-time loop
+void prefault_stack(size_t bytes);
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef RT_PERF_H
+#define RT_PERF_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rt
+{
+
+// performance counters of the calling thread (perf_event_open, Linux), opened as one group and read
+// with a single system call; counters the system does not provide (no PMU in a VM, perf_event_paranoid,
+// missing permissions) stay unavailable and read as 0
+class perf_counters
+{
+	public:
+		enum counter
+		{
+			cycles,
+			instructions,
+			llc_misses,        // last level cache
+			context_switches,  // software counter, usually available
+			num_counters
+		};
+
+		struct sample
+		{
+			uint64_t value[num_counters];
+		};
+
+		static const char * name(counter c);
+
+		// counts the calling thread from now on (user and kernel mode, or user mode only if the kernel is not allowed)
+		perf_counters();
+		~perf_counters();
+
+		perf_counters(const perf_counters &) = delete;
+		perf_counters & operator =(const perf_counters &) = delete;
+
+		bool available(counter c) const { return fds[c] >= 0; }
+		bool any() const { return leader >= 0; }
+
+		// current values, counted since construction
+		void read(sample & s) const;
+
+	private:
+		int fds[num_counters];
+		int leader = -1;
+		counter order[num_counters];  // counters in the order of the group
+		size_t opened = 0;
+};
+
+}
+
+#endif
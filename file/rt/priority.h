@@ -1,11 +1,15 @@
 #ifndef RT_PRIORITY_H
 #define RT_PRIORITY_H
 
+#include <pthread.h>
+#include <atomic>
 #include <thread>
 #include <string>
 #include <stdexcept>
 #include <ostream>
 
+#include "deadline.h"
+
 namespace rt
 {
 
@@ -44,6 +48,7 @@ class priority
 		unsigned int value;
 
 		friend std::ostream& operator <<(std::ostream& stream, const priority & p);
+		friend class cached_priority;
 };
 
 std::ostream& operator <<(std::ostream& stream, const priority & p);
@@ -58,6 +63,40 @@ priority get_priority(const std::thread & th);
 
 void set_priority(std::thread & th, const priority & p); // throw (permission_error)
 
+// Scheduling policy and priority (or SCHED_DEADLINE parameters) of a thread as last applied
+// through this object: set() skips the system call when nothing would change. Safe to use from
+// any thread: concurrent set() calls are serialised by a priority inheritance mutex (a real-time
+// caller may have to wait for the thread being changed), so the cache always matches the last
+// change applied. The cache is only valid if the thread's scheduling is not changed by other
+// means (see invalidate()).
+class cached_priority
+{
+	public:
+		cached_priority();
+		~cached_priority();
+
+		cached_priority(const cached_priority &) = delete;
+		cached_priority & operator =(const cached_priority &) = delete;
+
+		void bind(std::thread & th);  // resets the cache
+		void bind_tid(tid_t tid);     // kernel id of the same thread, needed by set(deadline_params)
+
+		priority get() const;         // not_rt under SCHED_DEADLINE
+		bool set(const priority & p); // throw (permission_error); false if already set
+		bool set(const deadline_params & p); // throw (permission_error); false if already set
+		void invalidate();
+
+	private:
+		static const unsigned int unknown = ~0U;
+		static const unsigned int deadline = ~0U - 1;  // SCHED_DEADLINE, with parameters "params"
+
+		std::thread::native_handle_type handle;
+		tid_t tid;
+		deadline_params params;       // written by set() only, under "lock"
+		std::atomic<unsigned int> value;
+		pthread_mutex_t lock;
+};
+
 namespace this_thread
 {
 priority get_priority();
@@ -193,6 +232,16 @@ inline bool priority::operator !=(const priority & p) const
 	return value != p.value;
 }
 
+inline void cached_priority::bind_tid(tid_t tid)
+{
+	this->tid = tid;
+}
+
+inline void cached_priority::invalidate()
+{
+	value.store(unknown, std::memory_order_relaxed);
+}
+
 inline permission_error::permission_error(const std::string&  what_arg) : std::runtime_error(what_arg)
 {
 }
@@ -0,0 +1,142 @@
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cassert>
+
+#include "affinity.h"
+
+namespace rt
+{
+
+size_t cpu_count()
+{
+	static const size_t count = []() {
+		long n = sysconf(_SC_NPROCESSORS_CONF);
+		return n > 0 ? static_cast<size_t>(n) : size_t(1);
+	}();
+	return count;
+}
+
+affinity::affinity() : bits(cpu_count()), words((bits + 63) / 64, 0)
+{
+}
+
+affinity::affinity(unsigned long long mask) : affinity()
+{
+	for (size_t cpu = 0; cpu < 64 && cpu < bits; ++cpu)
+		if ((mask >> cpu) & 1)
+			set(cpu);
+}
+
+affinity affinity::single(size_t cpu)
+{
+	affinity a;
+	a.set(cpu);
+	return a;
+}
+
+affinity affinity::parse(const std::string & list)
+{
+	affinity a;
+	const char * p = list.c_str();
+	while (*p)
+	{
+		char * end;
+		const unsigned long first = std::strtoul(p, &end, 10);
+		if (end == p)
+			break;
+		unsigned long last = first;
+		p = end;
+		if (*p == '-')
+		{
+			last = std::strtoul(p + 1, &end, 10);
+			p = end;
+		}
+		for (unsigned long cpu = first; cpu <= last && cpu < a.size(); ++cpu)
+			a.set(cpu);
+		while (*p == ',' || *p == ' ' || *p == '\n')
+			++p;
+	}
+	return a;
+}
+
+size_t affinity::count() const
+{
+	size_t n = 0;
+	for (auto w: words)
+		n += __builtin_popcountll(w);
+	return n;
+}
+
+bool affinity::any() const
+{
+	for (auto w: words)
+		if (w)
+			return true;
+	return false;
+}
+
+affinity & affinity::set()
+{
+	for (size_t cpu = 0; cpu < bits; ++cpu)
+		set(cpu);
+	return *this;
+}
+
+affinity & affinity::set(size_t cpu, bool value)
+{
+	assert(cpu < bits);
+	if (value)
+		words[cpu / 64] |= uint64_t(1) << (cpu % 64);
+	else
+		words[cpu / 64] &= ~(uint64_t(1) << (cpu % 64));
+	return *this;
+}
+
+size_t affinity::next(size_t cpu) const
+{
+	while (cpu < bits && !test(cpu))
+		++cpu;
+	return std::min(cpu, bits);
+}
+
+affinity & affinity::operator &=(const affinity & a)
+{
+	for (size_t i = 0; i < words.size(); ++i)
+		words[i] &= a.words[i];
+	return *this;
+}
+
+affinity & affinity::operator |=(const affinity & a)
+{
+	for (size_t i = 0; i < words.size(); ++i)
+		words[i] |= a.words[i];
+	return *this;
+}
+
+affinity & affinity::operator -=(const affinity & a)
+{
+	for (size_t i = 0; i < words.size(); ++i)
+		words[i] &= ~a.words[i];
+	return *this;
+}
+
+std::string affinity::to_string() const
+{
+	std::string list;
+	for (size_t cpu = next(); cpu < bits; )
+	{
+		size_t last = cpu;
+		while (last + 1 < bits && test(last + 1))
+			++last;
+		if (!list.empty())
+			list += ',';
+		list += std::to_string(cpu);
+		if (last > cpu)
+			list += '-' + std::to_string(last);
+		cpu = next(last + 1);
+	}
+	return list;
+}
+
+}
@@ -0,0 +1,81 @@
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include "deadline.h"
+#include "priority.h"
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+namespace rt
+{
+
+namespace detail
+{
+
+// struct sched_attr of the kernel (first version, 48 bytes): not exported by glibc
+struct sched_attr
+{
+	uint32_t size;
+	uint32_t sched_policy;
+	uint64_t sched_flags;
+	int32_t sched_nice;
+	uint32_t sched_priority;
+	uint64_t sched_runtime;
+	uint64_t sched_deadline;
+	uint64_t sched_period;
+};
+
+}
+
+std::chrono::nanoseconds max_deadline_period()
+{
+	static const std::chrono::nanoseconds max_period = []() {
+		long long us = 4194304;
+		std::ifstream("/proc/sys/kernel/sched_deadline_period_max_us") >> us;
+		return std::chrono::nanoseconds(std::chrono::microseconds(us));
+	}();
+	return max_period;
+}
+
+void set_deadline(tid_t tid, const deadline_params & p)
+{
+#ifdef SYS_sched_setattr
+	detail::sched_attr attr = {};
+	attr.size = sizeof(attr);
+	attr.sched_policy = SCHED_DEADLINE;
+	attr.sched_runtime = p.runtime.count();
+	attr.sched_deadline = p.deadline.count();
+	attr.sched_period = p.period.count();
+
+	if (syscall(SYS_sched_setattr, tid, &attr, 0) != 0)
+	{
+		char msg[30];
+		throw permission_error(strerror_r(errno, msg, 30));
+	}
+#else
+	throw permission_error("SCHED_DEADLINE not supported");
+#endif
+}
+
+namespace this_thread
+{
+
+tid_t tid()
+{
+	return static_cast<tid_t>(syscall(SYS_gettid));
+}
+
+void set_deadline(const deadline_params & p)
+{
+	rt::set_deadline(0, p);
+}
+
+}
+
+}
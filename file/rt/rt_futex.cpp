@@ -0,0 +1,43 @@
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#pragma message ("futex not available, falling back to yield")
+#include <thread>
+#endif
+
+#include "futex.h"
+
+namespace rt
+{
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "std::atomic<int> must be a plain int to be used as a futex word");
+
+#ifdef __linux__
+
+void futex_wait(std::atomic<int> & word, int expected)
+{
+	syscall(SYS_futex, reinterpret_cast<int *>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+void futex_wake(std::atomic<int> & word, int count)
+{
+	syscall(SYS_futex, reinterpret_cast<int *>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+#else
+
+void futex_wait(std::atomic<int> & word, int expected)
+{
+	if (word.load() == expected)
+		std::this_thread::yield();
+}
+
+void futex_wake(std::atomic<int> &, int)
+{
+}
+
+#endif
+
+}
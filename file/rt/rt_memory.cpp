@@ -0,0 +1,42 @@
+#include <alloca.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#include "memory.h"
+#include "priority.h"
+
+namespace rt
+{
+
+void lock_memory(bool on_fault)
+{
+	int flags = MCL_CURRENT | MCL_FUTURE;
+#ifdef MCL_ONFAULT
+	if (on_fault)
+		flags |= MCL_ONFAULT;
+#endif
+
+	if (mlockall(flags) != 0)
+	{
+		char msg[30];
+		throw permission_error(strerror_r(errno, msg, 30));
+	}
+
+	// freed memory stays in the process (and locked): no trimming, no mmap for large blocks
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+}
+
+__attribute__((noinline)) void prefault_stack(size_t bytes)
+{
+	static const size_t page = sysconf(_SC_PAGESIZE);
+
+	volatile char * stack = static_cast<volatile char *>(alloca(bytes));
+	for (size_t i = 0; i < bytes; i += page)
+		stack[i] = 0;
+}
+
+}
@@ -0,0 +1,84 @@
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "perf.h"
+
+namespace rt
+{
+
+const char * perf_counters::name(counter c)
+{
+	static const char * const names[num_counters] = {"cycles", "instructions", "llc_misses", "context_switches"};
+	return names[c];
+}
+
+perf_counters::perf_counters()
+{
+	for (size_t c = 0; c < num_counters; ++c)
+		fds[c] = -1;
+
+#ifdef __linux__
+	static const struct { uint32_t type; uint64_t config; } events[num_counters] = {
+		{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+		{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+		{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+		{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES}
+	};
+
+	for (size_t c = 0; c < num_counters; ++c)
+	{
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = events[c].type;
+		attr.config = events[c].config;
+		attr.read_format = PERF_FORMAT_GROUP;
+		attr.exclude_hv = 1;
+
+		// the first counter that opens leads the group, the others join it
+		int fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+		if (fd < 0 && errno == EACCES)
+		{
+			attr.exclude_kernel = 1;
+			fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+		}
+		if (fd < 0)
+			continue;
+
+		fds[c] = fd;
+		if (leader < 0)
+			leader = fd;
+		order[opened++] = static_cast<counter>(c);
+	}
+#endif
+}
+
+perf_counters::~perf_counters()
+{
+	for (size_t c = 0; c < num_counters; ++c)
+		if (fds[c] >= 0)
+			close(fds[c]);
+}
+
+void perf_counters::read(sample & s) const
+{
+	std::memset(&s, 0, sizeof(s));
+	if (leader < 0)
+		return;
+
+	// PERF_FORMAT_GROUP: number of counters, then their values in group order
+	uint64_t buffer[1 + num_counters];
+	if (::read(leader, buffer, sizeof(buffer)) < static_cast<ssize_t>(sizeof(uint64_t)))
+		return;
+	for (size_t i = 0; i < opened && i < buffer[0]; ++i)
+		s.value[order[i]] = buffer[1 + i];
+}
+
+}
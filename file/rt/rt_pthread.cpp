@@ -8,7 +8,9 @@
 
 #include <pthread.h>
 #include <sched.h>
+#include <cerrno>
 #include <cstring>
+#include <system_error>
 
 #include "priority.h"
 #include "affinity.h"
@@ -67,19 +69,39 @@ static void set_priority(pthread_t pthread_id, const priority & p)
 	}
 }
 
+class mutex_guard
+{
+	public:
+		explicit mutex_guard(pthread_mutex_t & m) : m(m) { pthread_mutex_lock(&m); }
+		~mutex_guard() { pthread_mutex_unlock(&m); }
+
+	private:
+		pthread_mutex_t & m;
+};
+
 static affinity get_affinity(pthread_t pthread_id)
 {
 	affinity a;
 
 #ifdef __linux__
-	cpu_set_t * cpuset = CPU_ALLOC(a.size());
-	
-	pthread_getaffinity_np(pthread_id, CPU_ALLOC_SIZE(a.size()), cpuset);
-
-	for (size_t i = 0; i < a.size(); ++i)
-		a[i] = CPU_ISSET_S(i, CPU_ALLOC_SIZE(a.size()), cpuset);
-
-	CPU_FREE(cpuset);
+	// the kernel mask can be larger than the configured CPUs (possible CPUs): EINVAL until the set holds it
+	for (size_t cpus = a.size(); ; cpus *= 2)
+	{
+		cpu_set_t * cpuset = CPU_ALLOC(cpus);
+		const size_t bytes = CPU_ALLOC_SIZE(cpus);
+
+		CPU_ZERO_S(bytes, cpuset);
+		const int res = pthread_getaffinity_np(pthread_id, bytes, cpuset);
+		if (res == 0)
+			for (size_t i = 0; i < a.size(); ++i)
+				a.set(i, CPU_ISSET_S(i, bytes, cpuset));
+
+		CPU_FREE(cpuset);
+		if (res == 0)
+			break;
+		if (res != EINVAL)
+			throw std::system_error(res, std::generic_category(), "pthread_getaffinity_np");
+	}
 #else
 	a.set();
 #endif
@@ -115,6 +137,67 @@ void set_priority(std::thread & th, const priority & p)
 	detail::set_priority(th.native_handle(), p);
 }
 
+cached_priority::cached_priority() : handle(), tid(0), value(unknown)
+{
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	pthread_mutex_init(&lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+cached_priority::~cached_priority()
+{
+	pthread_mutex_destroy(&lock);
+}
+
+void cached_priority::bind(std::thread & th)
+{
+	handle = th.native_handle();
+	invalidate();
+}
+
+priority cached_priority::get() const
+{
+	unsigned int v = value.load(std::memory_order_relaxed);
+	if (v == deadline)
+		return priority::not_rt;
+	return v != unknown ? priority(v) : detail::get_priority(handle);
+}
+
+bool cached_priority::set(const priority & p)
+{
+	detail::mutex_guard guard(lock);
+	if (value.load(std::memory_order_relaxed) == p.value)
+		return false;
+
+	try {
+		detail::set_priority(handle, p);
+	} catch (...) {
+		invalidate();
+		throw;
+	}
+	value.store(p.value, std::memory_order_relaxed);
+	return true;
+}
+
+bool cached_priority::set(const deadline_params & p)
+{
+	detail::mutex_guard guard(lock);
+	if (value.load(std::memory_order_acquire) == deadline && params == p)
+		return false;
+
+	try {
+		rt::set_deadline(tid, p);
+	} catch (...) {
+		invalidate();
+		throw;
+	}
+	params = p;
+	value.store(deadline, std::memory_order_release);
+	return true;
+}
+
 affinity get_affinity(const std::thread & th)
 {
 	return detail::get_affinity(const_cast<std::thread &>(th).native_handle());
@@ -0,0 +1,176 @@
+#ifdef __linux__
+#include <time.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <mutex>
+#include <system_error>
+#else
+#pragma message ("clock_nanosleep not available, falling back to std::this_thread::sleep_until")
+#include <system_error>
+#include <thread>
+#endif
+
+#include <cassert>
+
+#include "timer.h"
+
+namespace rt
+{
+
+typedef std::chrono::steady_clock mono_clock;
+
+void sleep_until(mono_clock::time_point t, std::chrono::nanoseconds spin)
+{
+	const mono_clock::time_point wake = t - spin;
+
+#ifdef __linux__
+	const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wake.time_since_epoch()).count();
+	timespec ts;
+	ts.tv_sec = ns / 1000000000;
+	ts.tv_nsec = ns % 1000000000;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+		;
+#else
+	std::this_thread::sleep_until(wake);
+#endif
+
+	while (spin.count() > 0 && mono_clock::now() < t)
+		;
+}
+
+std::chrono::nanoseconds thread_cpu_time()
+{
+#ifdef __linux__
+	timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+#else
+	return std::chrono::nanoseconds(0);
+#endif
+}
+
+frame_timer::frame_timer(mono_clock::time_point start, std::chrono::nanoseconds period,
+                         overrun_policy policy, uint64_t realign_frames, std::chrono::nanoseconds spin)
+	: start(start), period(period), policy(policy), realign_frames(realign_frames), spin(spin)
+{
+	assert(period.count() > 0 && realign_frames > 0);
+}
+
+void frame_timer::wait_start()
+{
+	sleep_until(start, spin);
+}
+
+void frame_timer::set_realign(uint64_t origin, uint64_t frames)
+{
+	assert(frames > 0 && origin <= current + 1);
+	realign_origin = origin;
+	realign_frames = frames;
+}
+
+uint64_t frame_timer::wait()
+{
+	uint64_t next = current + 1;
+	const mono_clock::time_point now = mono_clock::now();
+
+	if (now >= start + next * period)
+	{
+		overrun_count.fetch_add(1, std::memory_order_relaxed);
+
+		// first boundary after "now"
+		const uint64_t future = (now - start) / period + 1;
+		if (policy == skip)
+			next = future;
+		else if (policy == realign)
+			next = realign_origin + (future - realign_origin + realign_frames - 1) / realign_frames * realign_frames;
+
+		skipped_count.fetch_add(next - current - 1, std::memory_order_relaxed);
+	}
+
+	if (now < start + next * period)
+		sleep_until(start + next * period, spin);
+
+	const uint64_t advance = next - current;
+	current = next;
+	return advance;
+}
+
+#ifdef __linux__
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+alarm::alarm(handler_type handler, void * arg) : handler(handler), arg(arg)
+{
+	// one process-wide handler: the alarm to notify travels in the signal value
+	static std::once_flag installed;
+	std::call_once(installed, []() {
+		struct sigaction sa = {};
+		sa.sa_sigaction = &alarm::on_signal;
+		sa.sa_flags = SA_SIGINFO | SA_RESTART;
+		sigemptyset(&sa.sa_mask);
+		sigaction(SIGRTMIN, &sa, nullptr);
+	});
+
+	sigevent ev = {};
+	ev.sigev_notify = SIGEV_THREAD_ID;
+	ev.sigev_signo = SIGRTMIN;
+	ev.sigev_value.sival_ptr = this;
+	ev.sigev_notify_thread_id = syscall(SYS_gettid);
+	if (timer_create(CLOCK_MONOTONIC, &ev, &id) != 0)
+		throw std::system_error(errno, std::generic_category(), "timer_create");
+}
+
+alarm::~alarm()
+{
+	timer_delete(id);
+}
+
+void alarm::arm(mono_clock::time_point t)
+{
+	const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+	itimerspec spec = {};
+	spec.it_value.tv_sec = ns / 1000000000;
+	spec.it_value.tv_nsec = ns % 1000000000;
+	fired_flag.store(false, std::memory_order_relaxed);
+	timer_settime(id, TIMER_ABSTIME, &spec, nullptr);
+}
+
+void alarm::disarm()
+{
+	itimerspec spec = {};
+	timer_settime(id, 0, &spec, nullptr);
+}
+
+void alarm::on_signal(int, siginfo_t * info, void *)
+{
+	alarm * a = static_cast<alarm *>(info->si_value.sival_ptr);
+	a->fired_flag.store(true, std::memory_order_release);
+	a->handler(a->arg);
+}
+
+#else
+
+// no per-thread timer signals: the alarm cannot be created
+alarm::alarm(handler_type handler, void * arg) : handler(handler), arg(arg)
+{
+	throw std::system_error(std::make_error_code(std::errc::not_supported), "rt::alarm");
+}
+
+alarm::~alarm()
+{
+}
+
+void alarm::arm(mono_clock::time_point)
+{
+}
+
+void alarm::disarm()
+{
+}
+
+#endif
+
+}
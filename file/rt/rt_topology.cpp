@@ -0,0 +1,74 @@
+#include <fstream>
+#include <string>
+
+#include "topology.h"
+
+namespace rt
+{
+
+static const std::string cpu_dir = "/sys/devices/system/cpu/";
+static const std::string node_dir = "/sys/devices/system/node/";
+
+// first line of a sysfs file ("" if missing)
+static std::string read_line(const std::string & path)
+{
+	std::string line;
+	std::ifstream file(path);
+	std::getline(file, line);
+	return line;
+}
+
+affinity online_cpus()
+{
+	const std::string list = read_line(cpu_dir + "online");
+	if (list.empty())
+		return affinity().set();
+	return affinity::parse(list);
+}
+
+affinity smt_siblings(size_t cpu)
+{
+	affinity siblings = affinity::parse(read_line(cpu_dir + "cpu" + std::to_string(cpu) + "/topology/thread_siblings_list"));
+	return siblings.set(cpu);
+}
+
+affinity cache_domain(size_t cpu, unsigned int level)
+{
+	// cache/indexN: one entry per cache of the CPU (instruction and data caches of level 1 are separate)
+	const std::string cache = cpu_dir + "cpu" + std::to_string(cpu) + "/cache/index";
+	for (unsigned int index = 0; ; ++index)
+	{
+		const std::string dir = cache + std::to_string(index) + "/";
+		const std::string cache_level = read_line(dir + "level");
+		if (cache_level.empty())
+			break;
+		if (std::stoul(cache_level) == level && read_line(dir + "type") != "Instruction")
+			return affinity::parse(read_line(dir + "shared_cpu_list")).set(cpu);
+	}
+	return affinity::single(cpu);
+}
+
+std::vector<affinity> numa_nodes()
+{
+	std::vector<affinity> nodes;
+	const affinity online = affinity::parse(read_line(node_dir + "online"));
+	for (size_t node = online.next(); node < online.size(); node = online.next(node + 1))
+	{
+		nodes.resize(node + 1);
+		nodes[node] = affinity::parse(read_line(node_dir + "node" + std::to_string(node) + "/cpulist"));
+	}
+	if (nodes.empty())
+		nodes.push_back(affinity().set());
+	return nodes;
+}
+
+int numa_node_of(size_t cpu)
+{
+	const std::vector<affinity> nodes = numa_nodes();
+	for (size_t node = 0; node < nodes.size(); ++node)
+		if (nodes[node].test(cpu))
+			return static_cast<int>(node);
+	return -1;
+}
+
+}
@@ -0,0 +1,98 @@
+#ifndef RT_TIMER_H
+#define RT_TIMER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <csignal>
+#include <ctime>
+
+namespace rt
+{
+
+// absolute sleep on CLOCK_MONOTONIC (the clock behind std::chrono::steady_clock);
+// with spin > 0 wakes up "spin" earlier and busy-waits the rest
+void sleep_until(std::chrono::steady_clock::time_point t, std::chrono::nanoseconds spin = std::chrono::nanoseconds(0));
+
+// cpu time consumed so far by the calling thread (CLOCK_THREAD_CPUTIME_ID)
+std::chrono::nanoseconds thread_cpu_time();
+
+// periodic tick source: frame n starts at start + n * period
+class frame_timer
+{
+	public:
+		// what to do when wait() is called after the next boundary has already passed
+		enum overrun_policy
+		{
+			catch_up,  // run the late frame immediately (back-to-back frames until back on time)
+			skip,      // jump to the first boundary still in the future
+			realign    // jump to the first future boundary that is a multiple of realign_frames
+		};
+
+		frame_timer(std::chrono::steady_clock::time_point start, std::chrono::nanoseconds period,
+		            overrun_policy policy = catch_up, uint64_t realign_frames = 1,
+		            std::chrono::nanoseconds spin = std::chrono::nanoseconds(0));
+
+		// sleeps until the start of frame 0
+		void wait_start();
+
+		// from now on realign jumps to boundaries origin + k * frames (e.g. after the frame table changed)
+		void set_realign(uint64_t origin, uint64_t frames);
+
+		// sleeps until the start of the next frame, returns how many frames the index advanced (> 1 if frames were skipped)
+		uint64_t wait();
+
+		uint64_t frame() const { return current; }
+		std::chrono::steady_clock::time_point frame_start() const { return start + current * period; }
+
+		// may be read from any thread
+		uint64_t overruns() const { return overrun_count.load(std::memory_order_relaxed); }
+		uint64_t skipped() const { return skipped_count.load(std::memory_order_relaxed); }
+
+	private:
+		const std::chrono::steady_clock::time_point start;
+		const std::chrono::nanoseconds period;
+		const overrun_policy policy;
+		uint64_t realign_origin = 0;
+		uint64_t realign_frames;
+		const std::chrono::nanoseconds spin;
+		uint64_t current = 0;
+		std::atomic<uint64_t> overrun_count{0};
+		std::atomic<uint64_t> skipped_count{0};
+};
+
+// one-shot alarm on CLOCK_MONOTONIC delivered as a signal (SIGRTMIN, SA_RESTART) to the thread that
+// created the object: when the armed time passes, "handler(arg)" runs in that thread's signal handler,
+// interrupting whatever it is doing (only async-signal-safe code, e.g. lock-free atomic stores);
+// Linux only: elsewhere the constructor throws std::system_error (not_supported)
+class alarm
+{
+	public:
+		typedef void (*handler_type)(void * arg);
+
+		alarm(handler_type handler, void * arg); // throw (std::system_error)
+		~alarm();
+
+		alarm(const alarm &) = delete;
+		alarm & operator =(const alarm &) = delete;
+
+		void arm(std::chrono::steady_clock::time_point t);  // replaces the previous time
+		void disarm();
+
+		// true once the armed time has passed (reset by arm)
+		bool fired() const { return fired_flag.load(std::memory_order_acquire); }
+
+	private:
+		handler_type handler;
+		void * arg;
+#ifdef __linux__
+		static void on_signal(int, siginfo_t * info, void *);
+
+		timer_t id;
+#endif
+		std::atomic<bool> fired_flag{false};
+};
+
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef RT_TOPOLOGY_H
+#define RT_TOPOLOGY_H
+
+#include <vector>
+
+#include "affinity.h"
+
+namespace rt
+{
+
+// CPU topology read from sysfs (/sys/devices/system/cpu, /sys/devices/system/node); where the information
+// is missing (other systems, restricted containers) every CPU is its own physical core, with no shared cache,
+// and all CPUs are on NUMA node 0
+
+affinity online_cpus();
+
+// hardware threads of the physical core of "cpu" ("cpu" included)
+affinity smt_siblings(size_t cpu);
+
+// CPUs sharing the cache of level "level" (1 data, 2, 3) with "cpu" ("cpu" included)
+affinity cache_domain(size_t cpu, unsigned int level);
+
+std::vector<affinity> numa_nodes();  // CPUs of each node, indexed by node id
+int numa_node_of(size_t cpu);        // -1 if unknown
+
+}
+
+#endif
@@ -0,0 +1,238 @@
+#include "rt_log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rtlog
+{
+
+static const size_t ring_size = 128;  // record per thread (potenza di 2)
+static const size_t text_size = 48;   // byte per gli argomenti stringa di un record
+
+struct record
+{
+	int64_t time;
+	const char * fmt;
+	unsigned char lvl;
+	unsigned char num_args;
+	arg args[max_args];
+	char text[text_size];  // copie degli argomenti stringa (args[i].s punta qui)
+};
+
+// ring single-producer (il thread proprietario) single-consumer (il drain)
+struct ring
+{
+	record records[ring_size];
+	std::atomic<size_t> tail{0};  // scritto dal produttore
+	std::atomic<size_t> head{0};  // scritto dal consumatore
+	std::atomic<uint64_t> dropped{0};
+	std::atomic<bool> owned{true};  // false: il thread è terminato, il ring si può riusare
+	ring * next = nullptr;
+};
+
+static std::atomic<ring *> rings{nullptr};  // lista (solo inserimenti in testa) dei ring di tutti i thread
+static thread_local ring * this_ring = nullptr;
+
+// alla fine del thread il ring torna disponibile (i messaggi rimasti vengono comunque scritti)
+struct ring_owner
+{
+	~ring_owner()
+	{
+		if (this_ring)
+			this_ring->owned.store(false, std::memory_order_release);
+	}
+};
+static thread_local ring_owner owner;
+
+// stato del drain a livello di file: viene distrutto dopo l'handler atexit registrato da start()
+static std::mutex drain_mtx;   // serializza i consumatori (drain e flush) e start/stop
+static std::vector<record> batch;
+static std::string out, err;
+static std::thread drainer;
+static std::atomic<bool> draining{false};
+
+static int64_t now_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void register_thread()
+{
+	if (this_ring)
+		return;
+	(void)&owner;  // costruisce il distruttore del thread
+
+	for (ring * r = rings.load(std::memory_order_acquire); r; r = r->next)
+	{
+		bool owned = false;
+		if (!r->owned.load(std::memory_order_relaxed) &&
+		    r->owned.compare_exchange_strong(owned, true, std::memory_order_acq_rel))
+		{
+			this_ring = r;
+			return;
+		}
+	}
+
+	this_ring = new ring;
+	ring * head = rings.load(std::memory_order_relaxed);
+	do
+		this_ring->next = head;
+	while (!rings.compare_exchange_weak(head, this_ring, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void push(level l, const char * fmt, const arg * args, size_t num_args)
+{
+	register_thread();
+	ring & r = *this_ring;
+
+	const size_t tail = r.tail.load(std::memory_order_relaxed);
+	if (tail - r.head.load(std::memory_order_acquire) == ring_size)
+	{
+		r.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	record & rec = r.records[tail & (ring_size - 1)];
+	rec.time = now_ns();
+	rec.fmt = fmt;
+	rec.lvl = static_cast<unsigned char>(l);
+	rec.num_args = static_cast<unsigned char>(num_args);
+
+	size_t used = 0;
+	for (size_t i = 0; i < num_args; ++i)
+	{
+		rec.args[i] = args[i];
+		if (args[i].kind == arg::STR)
+		{
+			const char * s = args[i].s ? args[i].s : "(null)";
+			size_t len = std::min(std::strlen(s), text_size - 1 - used);
+			std::memcpy(rec.text + used, s, len);
+			rec.text[used + len] = '\0';
+			rec.args[i].s = rec.text + used;
+			used = std::min(used + len + 1, text_size - 1);
+		}
+	}
+
+	r.tail.store(tail + 1, std::memory_order_release);
+}
+
+static void format(const record & rec, std::string & out)
+{
+	char buf[32];
+	size_t next_arg = 0;
+
+	for (const char * p = rec.fmt; *p; ++p)
+	{
+		if (p[0] == '{' && p[1] == '}' && next_arg < rec.num_args)
+		{
+			const arg & a = rec.args[next_arg++];
+			switch (a.kind)
+			{
+				case arg::INT:    std::snprintf(buf, sizeof(buf), "%lld", a.i); out += buf; break;
+				case arg::UINT:   std::snprintf(buf, sizeof(buf), "%llu", a.u); out += buf; break;
+				case arg::DOUBLE: std::snprintf(buf, sizeof(buf), "%g", a.d); out += buf; break;
+				case arg::STR:    out += a.s; break;
+			}
+			++p;
+		}
+		else
+			out += *p;
+	}
+	out += '\n';
+}
+
+// estrae i record di tutti i ring, li ordina per istante di emissione e li scrive; con drain_mtx acquisito
+static void drain()
+{
+	uint64_t dropped = 0;
+	for (ring * r = rings.load(std::memory_order_acquire); r; r = r->next)
+	{
+		const size_t tail = r->tail.load(std::memory_order_acquire);
+		size_t head = r->head.load(std::memory_order_relaxed);
+		for (; head != tail; ++head)
+		{
+			const record & src = r->records[head & (ring_size - 1)];
+			batch.push_back(src);
+			// gli argomenti stringa puntano nel record originale: li riporta sulla copia
+			record & rec = batch.back();
+			for (size_t i = 0; i < rec.num_args; ++i)
+				if (rec.args[i].kind == arg::STR)
+					rec.args[i].s = rec.text + (src.args[i].s - src.text);
+		}
+		r->head.store(head, std::memory_order_release);
+		dropped += r->dropped.exchange(0, std::memory_order_relaxed);
+	}
+
+	std::stable_sort(batch.begin(), batch.end(), [](const record & a, const record & b) { return a.time < b.time; });
+	for (auto & rec: batch)
+		format(rec, rec.lvl >= WARN ? err : out);
+	if (dropped > 0)
+		err += "[WARN] rtlog: " + std::to_string(dropped) + " messaggi scartati (ring pieno)\n";
+	batch.clear();
+
+	if (!out.empty())
+	{
+		std::fwrite(out.data(), 1, out.size(), stdout);
+		std::fflush(stdout);
+		out.clear();
+	}
+	if (!err.empty())
+	{
+		std::fwrite(err.data(), 1, err.size(), stderr);
+		err.clear();
+	}
+}
+
+void start()
+{
+	std::lock_guard<std::mutex> lock(drain_mtx);
+	if (draining.load(std::memory_order_relaxed))
+		return;
+
+	// all'uscita del processo il thread va fermato e i messaggi rimasti scritti
+	static bool exit_hook = false;
+	if (!exit_hook)
+	{
+		std::atexit(stop);
+		exit_hook = true;
+	}
+
+	draining.store(true, std::memory_order_release);
+	// thread a priorità normale (non real-time): eredita la politica del chiamante, che non è ancora RT
+	drainer = std::thread([]() {
+		while (draining.load(std::memory_order_acquire))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			std::lock_guard<std::mutex> lock(drain_mtx);
+			drain();
+		}
+	});
+}
+
+void stop()
+{
+	bool was_draining;
+	{
+		std::lock_guard<std::mutex> lock(drain_mtx);
+		was_draining = draining.exchange(false, std::memory_order_acq_rel);
+	}
+	if (was_draining)
+		drainer.join();
+	flush();
+}
+
+void flush()
+{
+	std::lock_guard<std::mutex> lock(drain_mtx);
+	drain();
+}
+
+}
@@ -0,0 +1,99 @@
+#ifndef RT_LOG_H
+#define RT_LOG_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/* Livello minimo dei messaggi compilati: quelli sotto RTLOG_LEVEL spariscono dal codice
+   (es. -DRTLOG_LEVEL=1 elimina la traccia dei frame dell'executive). */
+#ifndef RTLOG_LEVEL
+#define RTLOG_LEVEL 0
+#endif
+
+/* Logger non bloccante per i thread real-time.
+   Ogni thread scrive record binari (formato + argomenti) nel proprio ring buffer lock-free,
+   senza formattare nè fare system call; un thread di drain non real-time li formatta e li scrive
+   (livelli warn/error su stderr, gli altri su stdout). Se il ring è pieno il messaggio viene
+   scartato e contato. Il formato usa "{}" come segnaposto ed è salvato come puntatore: deve
+   essere una stringa letterale; gli argomenti stringa invece vengono copiati (troncati).
+   Il primo messaggio di un thread alloca il suo ring (o riusa quello lasciato da un thread
+   terminato): i thread real-time possono anticiparlo con register_thread(). */
+namespace rtlog
+{
+
+enum level { DEBUG = 0, INFO = 1, WARN = 2, ERROR = 3 };
+
+struct arg
+{
+	enum { INT, UINT, DOUBLE, STR } kind;
+	union
+	{
+		long long i;
+		unsigned long long u;
+		double d;
+		const char * s;
+	};
+};
+
+static const size_t max_args = 4;
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, arg>::type make_arg(T v)
+{
+	arg a; a.kind = arg::INT; a.i = v; return a;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, arg>::type make_arg(T v)
+{
+	arg a; a.kind = arg::UINT; a.u = v; return a;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, arg>::type make_arg(T v)
+{
+	arg a; a.kind = arg::DOUBLE; a.d = v; return a;
+}
+
+inline arg make_arg(const char * v)
+{
+	arg a; a.kind = arg::STR; a.s = v; return a;
+}
+
+// accoda un messaggio nel ring del thread chiamante (non blocca)
+void push(level l, const char * fmt, const arg * args, size_t num_args);
+
+// alloca il ring del thread chiamante (facoltativo, da fare prima di entrare nel ciclo real-time)
+void register_thread();
+
+// avvia il thread di drain (idempotente)
+void start();
+
+// ferma il thread di drain e scrive i messaggi in coda; i messaggi successivi restano nei ring fino a flush()
+// o a un nuovo start(). Viene invocata anche all'uscita del processo (atexit)
+void stop();
+
+// formatta e scrive subito tutti i messaggi in coda (da un thread non real-time)
+void flush();
+
+template <level L, typename... Args>
+inline void write(const char * fmt, const Args &... args)
+{
+	static_assert(sizeof...(Args) <= max_args, "rtlog: troppi argomenti");
+	if (L >= RTLOG_LEVEL)
+	{
+		const arg a[sizeof...(Args) + 1] = {make_arg(args)...};
+		push(L, fmt, a, sizeof...(Args));
+	}
+}
+
+template <typename... Args> inline void debug(const char * fmt, const Args &... args) { write<DEBUG>(fmt, args...); }
+template <typename... Args> inline void info(const char * fmt, const Args &... args) { write<INFO>(fmt, args...); }
+template <typename... Args> inline void warn(const char * fmt, const Args &... args) { write<WARN>(fmt, args...); }
+template <typename... Args> inline void error(const char * fmt, const Args &... args) { write<ERROR>(fmt, args...); }
+
+}
+
+#endif
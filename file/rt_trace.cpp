@@ -0,0 +1,182 @@
+#include "rt_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace rttrace
+{
+
+// ring single-producer (il thread proprietario) single-consumer (il thread di scrittura)
+struct ring
+{
+	// azzerato: le pagine vengono toccate qui, non al primo giro del ring
+	explicit ring(size_t capacity) : events(new event[capacity]()), mask(capacity - 1) {}
+
+	event * events;
+	const size_t mask;
+	std::atomic<size_t> tail{0};  // scritto dal produttore
+	std::atomic<size_t> head{0};  // scritto dal consumatore
+	std::atomic<uint64_t> dropped{0};
+	std::atomic<bool> owned{true};  // false: il thread è terminato, il ring si può riusare
+	ring * next = nullptr;
+};
+
+static std::atomic<ring *> rings{nullptr};  // lista (solo inserimenti in testa) dei ring di tutti i thread
+static thread_local ring * this_ring = nullptr;
+
+// alla fine del thread il ring torna disponibile (gli eventi rimasti vengono comunque scritti)
+struct ring_owner
+{
+	~ring_owner()
+	{
+		if (this_ring)
+			this_ring->owned.store(false, std::memory_order_release);
+	}
+};
+static thread_local ring_owner owner;
+
+static std::atomic<bool> enabled{false};
+static std::mutex drain_mtx;  // serializza i consumatori e start/stop
+static FILE * out = nullptr;
+static std::thread writer;
+static std::atomic<bool> writing{false};
+static uint64_t dropped_total = 0;
+
+static int64_t now_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void register_thread(size_t capacity)
+{
+	if (this_ring)
+		return;
+	(void)&owner;  // costruisce il distruttore del thread
+
+	size_t size = 1;
+	while (size < capacity)
+		size <<= 1;
+
+	for (ring * r = rings.load(std::memory_order_acquire); r; r = r->next)
+	{
+		bool owned = false;
+		if (r->mask + 1 >= size && !r->owned.load(std::memory_order_relaxed) &&
+		    r->owned.compare_exchange_strong(owned, true, std::memory_order_acq_rel))
+		{
+			this_ring = r;
+			return;
+		}
+	}
+
+	this_ring = new ring(size);
+	ring * head = rings.load(std::memory_order_relaxed);
+	do
+		this_ring->next = head;
+	while (!rings.compare_exchange_weak(head, this_ring, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void record(event_type type, uint32_t id, uint64_t value)
+{
+	if (!enabled.load(std::memory_order_relaxed))
+		return;
+	if (!this_ring)
+		register_thread();
+	ring & r = *this_ring;
+
+	const size_t tail = r.tail.load(std::memory_order_relaxed);
+	if (tail - r.head.load(std::memory_order_acquire) > r.mask)
+	{
+		r.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	event & e = r.events[tail & r.mask];
+	e.time = now_ns();
+	e.value = value;
+	e.id = id;
+	e.type = type;
+	e.reserved = 0;
+	r.tail.store(tail + 1, std::memory_order_release);
+}
+
+// riversa nel file gli eventi di tutti i ring ("out" nullptr: li scarta); con drain_mtx acquisito
+static void drain()
+{
+	for (ring * r = rings.load(std::memory_order_acquire); r; r = r->next)
+	{
+		const size_t tail = r->tail.load(std::memory_order_acquire);
+		size_t head = r->head.load(std::memory_order_relaxed);
+		while (out && head != tail)
+		{
+			// fino alla fine del ring o agli eventi disponibili
+			const size_t begin = head & r->mask;
+			const size_t count = std::min(tail - head, r->mask + 1 - begin);
+			std::fwrite(r->events + begin, sizeof(event), count, out);
+			head += count;
+		}
+		r->head.store(tail, std::memory_order_release);
+		dropped_total += r->dropped.exchange(0, std::memory_order_relaxed);
+	}
+}
+
+bool start(const char * path)
+{
+	std::lock_guard<std::mutex> lock(drain_mtx);
+	if (out)
+		return false;
+	out = std::fopen(path, "wb");
+	if (!out)
+		return false;
+
+	file_header header = {};
+	std::memcpy(header.magic, magic, sizeof(header.magic));
+	header.version = version;
+	header.event_size = sizeof(event);
+	std::fwrite(&header, sizeof(header), 1, out);
+
+	// eventi di una traccia precedente rimasti nei ring: non appartengono a questo file
+	FILE * file = out;
+	out = nullptr;
+	drain();
+	out = file;
+	dropped_total = 0;
+
+	enabled.store(true, std::memory_order_release);
+	writing.store(true, std::memory_order_release);
+	// thread non real-time: eredita la politica del chiamante, che non è ancora RT
+	writer = std::thread([]() {
+		while (writing.load(std::memory_order_acquire))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			std::lock_guard<std::mutex> lock(drain_mtx);
+			drain();
+		}
+	});
+	return true;
+}
+
+uint64_t stop()
+{
+	if (!enabled.exchange(false, std::memory_order_acq_rel))
+		return 0;
+	writing.store(false, std::memory_order_release);
+	writer.join();
+
+	std::lock_guard<std::mutex> lock(drain_mtx);
+	drain();
+	std::fclose(out);
+	out = nullptr;
+	return dropped_total;
+}
+
+bool active()
+{
+	return enabled.load(std::memory_order_relaxed);
+}
+
+}
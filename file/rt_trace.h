@@ -0,0 +1,66 @@
+#ifndef RT_TRACE_H
+#define RT_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/* Traccia binaria degli eventi dell'executive, per i thread real-time.
+   Ogni thread scrive eventi di dimensione fissa (istante in ns sul clock monotono, tipo, id, valore) nel
+   proprio ring preallocato, senza allocazioni nè system call; un thread di scrittura non real-time
+   li riversa periodicamente nel file aperto da start(). Se il ring è pieno l'evento viene scartato e
+   contato. Finchè la traccia non è attiva record() costa un controllo e ritorna.
+   Il file (file_header seguito dagli eventi, in ordine per thread e non globale) si converte in JSON
+   per chrome://tracing o Perfetto con trace_convert. */
+namespace rttrace
+{
+
+enum event_type : uint16_t {
+	TASK_INFO,   // id: task (| ap_flag), value: core (emesso da Executive::start)
+	FRAME,       // id: core, value: frame assoluto che inizia
+	RELEASE,     // id: task, value: frame assoluto del rilascio
+	START,       // id: task (| ap_flag), value: istante nominale di rilascio (o di arrivo) del job
+	FINISH,      // id: task (| ap_flag), value: 1 se il job è stato interrotto (ABORT)
+	PRIORITY,    // id: task (| ap_flag), value: nuova priorità del thread
+	MISS,        // id: task (| ap_flag), value: frame assoluto in cui è stato rilevato il deadline miss
+	AP_REQUEST   // id: task aperiodico, value: 1 accettata, 0 rifiutata
+};
+
+static const uint32_t ap_flag = 0x80000000;  // id dei task aperiodici
+
+struct event
+{
+	int64_t time;
+	uint64_t value;
+	uint32_t id;
+	uint16_t type;
+	uint16_t reserved;
+};
+
+struct file_header
+{
+	char magic[8];  // "RTTRACE"
+	uint32_t version;
+	uint32_t event_size;
+};
+
+static const char magic[8] = "RTTRACE";
+static const uint32_t version = 1;
+
+// apre il file e attiva la traccia (false se non si può aprire); il thread di scrittura non è real-time
+bool start(const char * path);
+
+// scrive gli eventi rimasti, chiude il file e disattiva la traccia: restituisce gli eventi scartati
+uint64_t stop();
+
+bool active();
+
+// alloca il ring del thread chiamante, di almeno "capacity" eventi (arrotondati alla potenza di 2), o riusa
+// quello lasciato da un thread terminato; facoltativo: senza, il primo evento alloca un ring di 256 eventi
+void register_thread(size_t capacity = 256);
+
+// accoda un evento nel ring del thread chiamante (non blocca)
+void record(event_type type, uint32_t id, uint64_t value = 0);
+
+}
+
+#endif
@@ -0,0 +1,376 @@
+#include "schedule.h"
+#include "executive.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+
+namespace
+{
+
+// limite al numero di frame nell'iperperiodo (la tabella viene allocata per intero)
+const uint64_t max_frames = 1 << 20;
+// limite al numero di job nell'iperperiodo (vengono espansi tutti prima dell'assegnamento)
+const uint64_t max_jobs = 1 << 20;
+
+struct job
+{
+	size_t task;
+	unsigned int release;
+	unsigned int deadline;  // assoluta
+	unsigned int next;      // rilascio del job successivo dello stesso task
+	unsigned int wcet;
+};
+
+// assegnamento di un job: (frame, quanti) in ordine di frame
+typedef std::vector< std::pair<size_t, unsigned int> > placement;
+
+unsigned int gcd(unsigned int a, unsigned int b)
+{
+	while (b != 0)
+	{
+		unsigned int r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
+
+unsigned int relative_deadline(const task_spec & t)
+{
+	return t.deadline ? t.deadline : t.period;
+}
+
+unsigned int hyperperiod(const std::vector<task_spec> & tasks)
+{
+	uint64_t h = 1;
+	for (auto & t: tasks)
+	{
+		h = h / gcd(static_cast<unsigned int>(h), t.period) * t.period;
+		if (h > UINT_MAX)
+			throw schedule_error("iperperiodo troppo grande");
+	}
+	return static_cast<unsigned int>(h);
+}
+
+void check_tasks(const std::vector<task_spec> & tasks)
+{
+	if (tasks.empty())
+		throw schedule_error("task set vuoto");
+
+	for (size_t i = 0; i < tasks.size(); ++i)
+	{
+		const task_spec & t = tasks[i];
+		if (t.period == 0 || t.wcet == 0 || t.wcet > relative_deadline(t) || t.wcet > t.period)
+			throw schedule_error("parametri non validi per il task " + std::to_string(i) +
+			                     " (richiesto 0 < C <= min(D, T))");
+	}
+}
+
+std::vector<job> expand_jobs(const std::vector<task_spec> & tasks, unsigned int h)
+{
+	std::vector<job> jobs;
+	for (size_t i = 0; i < tasks.size(); ++i)
+		for (unsigned int r = 0; r < h; r += tasks[i].period)
+			jobs.push_back(job{i, r, r + relative_deadline(tasks[i]), r + tasks[i].period, tasks[i].wcet});
+
+	// ordine di deadline (a parità, di rilascio e di task): usato sia dal first-fit sia per l'ordine nei frame
+	std::sort(jobs.begin(), jobs.end(), [](const job & a, const job & b) {
+		return std::tie(a.deadline, a.release, a.task) < std::tie(b.deadline, b.release, b.task);
+	});
+	return jobs;
+}
+
+// frame [first, last) interamente contenuti nella finestra del job (senza ricircolo oltre l'iperperiodo)
+size_t first_frame(const job & j, unsigned int f) { return (j.release + f - 1) / f; }
+size_t last_frame(const job & j, unsigned int f, size_t num_frames) { return std::min<size_t>(j.deadline / f, num_frames); }
+
+/* Ogni job intero nel primo frame utile con spazio sufficiente.
+   Con D > T le finestre di job consecutivi si sovrappongono: ogni job va comunque dopo il precedente
+   dello stesso task (mai due job dello stesso task nello stesso frame). */
+bool assign_whole(const std::vector<job> & jobs, size_t num_tasks, unsigned int f, size_t num_frames, std::vector<placement> & out)
+{
+	std::vector<unsigned int> free_units(num_frames, f);
+	std::vector<size_t> first_free(num_tasks, 0);
+
+	out.assign(jobs.size(), placement());
+	for (size_t k = 0; k < jobs.size(); ++k)
+	{
+		const job & j = jobs[k];
+		size_t fr = std::max(first_frame(j, f), first_free[j.task]);
+		while (fr < last_frame(j, f, num_frames) && free_units[fr] < j.wcet)
+			++fr;
+		if (fr >= last_frame(j, f, num_frames))
+			return false;
+
+		free_units[fr] -= j.wcet;
+		first_free[j.task] = fr + 1;
+		out[k].push_back(std::make_pair(fr, j.wcet));
+	}
+	return true;
+}
+
+/* Come assign_whole, ma un job che non entra intero in nessun frame viene distribuito sui primi
+   frame liberi della sua finestra (riempimento in ordine di deadline). */
+bool assign_fill(const std::vector<job> & jobs, size_t num_tasks, unsigned int f, size_t num_frames, std::vector<placement> & out)
+{
+	std::vector<unsigned int> free_units(num_frames, f);
+	std::vector<size_t> first_free(num_tasks, 0);
+
+	out.assign(jobs.size(), placement());
+	for (size_t k = 0; k < jobs.size(); ++k)
+	{
+		const job & j = jobs[k];
+		const size_t first = std::max(first_frame(j, f), first_free[j.task]);
+		const size_t last = last_frame(j, f, num_frames);
+
+		size_t fr = first;
+		while (fr < last && free_units[fr] < j.wcet)
+			++fr;
+
+		if (fr < last)
+			out[k].push_back(std::make_pair(fr, j.wcet));
+		else
+		{
+			unsigned int left = j.wcet;
+			for (fr = first; fr < last && left > 0; ++fr)
+				if (free_units[fr] > 0)
+				{
+					unsigned int units = std::min(left, free_units[fr]);
+					out[k].push_back(std::make_pair(fr, units));
+					left -= units;
+				}
+			if (left > 0)
+				return false;
+		}
+
+		for (auto & p: out[k])
+			free_units[p.first] -= p.second;
+		first_free[j.task] = out[k].back().first + 1;
+	}
+	return true;
+}
+
+/* Flusso massimo (Dinic) su sorgente -> job -> frame -> pozzo */
+class max_flow
+{
+	public:
+		explicit max_flow(size_t n) : adj(n), level(n), next(n) {}
+
+		size_t add_edge(size_t from, size_t to, unsigned int cap)
+		{
+			adj[from].push_back(edges.size());
+			edges.push_back(edge{to, cap});
+			adj[to].push_back(edges.size());
+			edges.push_back(edge{from, 0});
+			return edges.size() - 2;
+		}
+
+		unsigned int flow(size_t e) const { return edges[e ^ 1].cap; }
+
+		uint64_t run(size_t s, size_t t)
+		{
+			uint64_t total = 0;
+			while (bfs(s, t))
+			{
+				std::fill(next.begin(), next.end(), 0);
+				while (unsigned int pushed = dfs(s, t, UINT_MAX))
+					total += pushed;
+			}
+			return total;
+		}
+
+	private:
+		struct edge
+		{
+			size_t to;
+			unsigned int cap;
+		};
+
+		std::vector<edge> edges;
+		std::vector< std::vector<size_t> > adj;
+		std::vector<int> level;
+		std::vector<size_t> next;
+
+		bool bfs(size_t s, size_t t)
+		{
+			std::fill(level.begin(), level.end(), -1);
+			std::vector<size_t> queue(1, s);
+			level[s] = 0;
+			for (size_t q = 0; q < queue.size(); ++q)
+				for (auto e: adj[queue[q]])
+					if (edges[e].cap > 0 && level[edges[e].to] < 0)
+					{
+						level[edges[e].to] = level[queue[q]] + 1;
+						queue.push_back(edges[e].to);
+					}
+			return level[t] >= 0;
+		}
+
+		unsigned int dfs(size_t u, size_t t, unsigned int limit)
+		{
+			if (u == t)
+				return limit;
+			for (; next[u] < adj[u].size(); ++next[u])
+			{
+				edge & e = edges[adj[u][next[u]]];
+				if (e.cap == 0 || level[e.to] != level[u] + 1)
+					continue;
+				if (unsigned int pushed = dfs(e.to, t, std::min(limit, e.cap)))
+				{
+					e.cap -= pushed;
+					edges[adj[u][next[u]] ^ 1].cap += pushed;
+					return pushed;
+				}
+			}
+			return 0;
+		}
+};
+
+/* I job possono essere spezzati su più frame: fattibile sse il flusso massimo satura tutti i wcet.
+   Per tenere disgiunti i job dello stesso task la finestra è limitata al rilascio del job successivo
+   (con D > T è una restrizione: può scartare schedule esistenti). */
+bool assign_split(const std::vector<job> & jobs, unsigned int f, size_t num_frames, std::vector<placement> & out)
+{
+	const size_t source = 0, sink = 1, first_job = 2, first_fr = first_job + jobs.size();
+	max_flow net(first_fr + num_frames);
+	std::vector< std::vector< std::pair<size_t, size_t> > > job_edges(jobs.size());  // (frame, arco)
+	uint64_t demand = 0;
+
+	for (size_t k = 0; k < jobs.size(); ++k)
+	{
+		const job & j = jobs[k];
+		net.add_edge(source, first_job + k, j.wcet);
+		demand += j.wcet;
+		for (size_t fr = first_frame(j, f); fr < std::min<size_t>(last_frame(j, f, num_frames), j.next / f); ++fr)
+			job_edges[k].push_back(std::make_pair(fr, net.add_edge(first_job + k, first_fr + fr, std::min(j.wcet, f))));
+	}
+	for (size_t fr = 0; fr < num_frames; ++fr)
+		net.add_edge(first_fr + fr, sink, f);
+
+	if (net.run(source, sink) != demand)
+		return false;
+
+	out.assign(jobs.size(), placement());
+	for (size_t k = 0; k < jobs.size(); ++k)
+		for (auto & je: job_edges[k])
+			if (unsigned int units = net.flow(je.second))
+				out[k].push_back(std::make_pair(je.first, units));
+	return true;
+}
+
+frame_schedule build(const std::vector<job> & jobs, const std::vector<placement> & where, unsigned int h, unsigned int f)
+{
+	frame_schedule s;
+	s.hyperperiod = h;
+	s.frame_length = f;
+
+	// ogni (task, posizione nel job, wcet) distinto diventa un task dell'executive
+	std::map<std::tuple<size_t, unsigned int, unsigned int>, size_t> ids;
+	for (size_t k = 0; k < jobs.size(); ++k)
+		for (unsigned int i = 0; i < where[k].size(); ++i)
+			ids[std::make_tuple(jobs[k].task, i, where[k][i].second)] = 0;
+	for (auto & id: ids)
+	{
+		id.second = s.slices.size();
+		s.slices.push_back(slice{std::get<0>(id.first), std::get<1>(id.first), std::get<2>(id.first)});
+	}
+
+	// i job sono in ordine di deadline, quindi lo è anche ogni frame
+	s.frames.resize(h / f);
+	for (size_t k = 0; k < jobs.size(); ++k)
+		for (unsigned int i = 0; i < where[k].size(); ++i)
+			s.frames[where[k][i].first].push_back(ids[std::make_tuple(jobs[k].task, i, where[k][i].second)]);
+
+	return s;
+}
+
+}
+
+std::vector<unsigned int> feasible_frame_sizes(const std::vector<task_spec> & tasks, bool allow_split)
+{
+	check_tasks(tasks);
+
+	unsigned int max_wcet = 0;
+	std::set<unsigned int> periods, candidates;
+	for (auto & t: tasks)
+	{
+		max_wcet = std::max(max_wcet, t.wcet);
+		periods.insert(t.period);
+	}
+
+	// m deve dividere almeno un periodo: i candidati sono i divisori dei periodi distinti
+	for (auto p: periods)
+		for (unsigned int d = 1; d * d <= p; ++d)
+			if (p % d == 0)
+			{
+				candidates.insert(d);
+				candidates.insert(p / d);
+			}
+
+	std::vector<unsigned int> sizes;
+	for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+	{
+		const unsigned int f = *it;
+		if (!allow_split && f < max_wcet)
+			break;
+
+		bool deadlines = true;
+		for (auto & t: tasks)
+			deadlines = deadlines && 2 * f - gcd(t.period, f) <= relative_deadline(t);
+		if (deadlines)
+			sizes.push_back(f);
+	}
+	return sizes;
+}
+
+frame_schedule synthesize_schedule(const std::vector<task_spec> & tasks)
+{
+	check_tasks(tasks);
+
+	const unsigned int h = hyperperiod(tasks);
+	uint64_t demand = 0, count = 0;
+	for (auto & t: tasks)
+	{
+		demand += static_cast<uint64_t>(t.wcet) * (h / t.period);
+		count += h / t.period;
+	}
+	if (demand > h)
+		throw schedule_error("utilizzazione maggiore di 1");
+	if (count > max_jobs)
+		throw schedule_error("troppi job nell'iperperiodo (" + std::to_string(count) + ")");
+
+	// i limiti si controllano prima di espandere i job
+	auto too_many_frames = [h](unsigned int f) { return h / f > max_frames; };
+	std::vector<unsigned int> whole = feasible_frame_sizes(tasks, false), split = feasible_frame_sizes(tasks, true);
+	whole.erase(std::remove_if(whole.begin(), whole.end(), too_many_frames), whole.end());
+	split.erase(std::remove_if(split.begin(), split.end(), too_many_frames), split.end());
+	if (split.empty())
+		throw schedule_error("nessun frame ammissibile con al più " + std::to_string(max_frames) + " frame nell'iperperiodo");
+
+	const std::vector<job> jobs = expand_jobs(tasks, h);
+	std::vector<placement> where;
+
+	for (auto f: whole)
+		if (assign_whole(jobs, tasks.size(), f, h / f, where))
+			return build(jobs, where, h, f);
+
+	for (auto f: split)
+		if (assign_fill(jobs, tasks.size(), f, h / f, where) || assign_split(jobs, f, h / f, where))
+			return build(jobs, where, h, f);
+
+	throw schedule_error("nessuno schedule ciclico fattibile");
+}
+
+void frame_schedule::apply(Executive & exec, const std::function<std::function<void()>(const slice &)> & bind) const
+{
+	for (size_t id = 0; id < slices.size(); ++id)
+		exec.set_periodic_task(id, bind(slices[id]), slices[id].wcet);
+
+	for (auto & frame: frames)
+		exec.add_frame(frame);
+}
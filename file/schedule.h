@@ -0,0 +1,60 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <vector>
+#include <functional>
+#include <stdexcept>
+
+class Executive;
+
+/* Parametri di un task periodico (tutti in quanti temporali) */
+struct task_spec
+{
+	unsigned int period;
+	unsigned int wcet;
+	unsigned int deadline;  // deadline relativa, 0 = pari al periodo
+};
+
+/* Porzione di un job eseguita in un singolo frame: ogni slice distinta diventa un task dell'executive */
+struct slice
+{
+	size_t task;         // indice del task nel task set
+	unsigned int index;  // posizione della slice all'interno del job (0 = prima)
+	unsigned int wcet;   // quanti eseguiti dalla slice
+};
+
+/* Schedule ciclico prodotto da synthesize_schedule() */
+struct frame_schedule
+{
+	unsigned int hyperperiod;                  // H (in quanti)
+	unsigned int frame_length;                 // m (in quanti)
+	std::vector<slice> slices;                 // task dell'executive: l'id è l'indice nel vettore
+	std::vector< std::vector<size_t> > frames; // H/m frame, ognuno con gli id delle slice in ordine di esecuzione
+
+	/* [INIT] Carica lo schedule in un executive costruito con Executive(slices.size(), frame_length, ...):
+		bind: restituisce la funzione da eseguire per una data slice.
+	*/
+	void apply(Executive & exec, const std::function<std::function<void()>(const slice &)> & bind) const;
+};
+
+class schedule_error : public std::runtime_error
+{
+	public:
+		explicit schedule_error(const std::string & what_arg) : std::runtime_error(what_arg) {}
+};
+
+/* Dimensioni di frame ammissibili per il task set, in ordine decrescente:
+	m divide almeno un periodo e 2m - gcd(T_i, m) <= D_i per ogni task;
+	se allow_split è false si richiede anche m >= max C_i.
+*/
+std::vector<unsigned int> feasible_frame_sizes(const std::vector<task_spec> & tasks, bool allow_split);
+
+/* Costruisce uno schedule ciclico fattibile (throw schedule_error se non esiste).
+	Per ogni frame ammissibile, dal più grande, prova prima un assegnamento dei job interi
+	(first-fit in ordine di deadline); se non basta, spezza in slice i job che non entrano in
+	un frame (riempimento first-fit) e, in ultima istanza, risolve un problema di flusso
+	massimo job -> frame.
+*/
+frame_schedule synthesize_schedule(const std::vector<task_spec> & tasks);
+
+#endif
@@ -0,0 +1,25 @@
+#include "schedule_file.h"
+#include <iostream>
+
+/* Traduce uno schedule (schedule_file.h) nella forma binaria, caricata con mmap senza parsing:
+	schedule_compile <schedule> <schedule binario>
+*/
+int main(int argc, char ** argv)
+{
+	if (argc != 3)
+	{
+		std::cerr << "uso: " << argv[0] << " <schedule> <schedule binario>" << std::endl;
+		return 2;
+	}
+
+	try {
+		schedule_file sched(argv[1]);
+		sched.save(argv[2]);
+		std::cout << argv[2] << ": " << sched.num_tasks() << " task, " << sched.num_frames() << " frame" << std::endl;
+	} catch (const schedule_error & e) {
+		std::cerr << "[ERROR] " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,327 @@
+#include "schedule_file.h"
+#include "executive.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// forma binaria: tutte parole da 32 bit, nell'ordine
+struct schedule_file::header
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t frame_length;
+	uint32_t unit_duration;
+	uint32_t num_tasks;
+	uint32_t num_frames;
+	uint32_t table_size;   // id nella tabella piatta dei frame
+	uint32_t names_size;   // byte dei nomi (stringhe terminate da '\0', multiplo di 4)
+	// task_record tasks[num_tasks];
+	// uint32_t frame_begin[num_frames + 1];
+	// uint32_t table[table_size];
+	// char names[names_size];
+};
+
+struct schedule_file::task_record
+{
+	uint32_t wcet;
+	uint32_t name;  // offset nei nomi
+};
+
+namespace
+{
+
+const uint32_t magic = 0x44484353;  // "SCHD"
+const uint32_t version = 1;
+const size_t header_words = 8;
+const size_t task_words = 2;
+
+std::string error_at(size_t line, const std::string & what)
+{
+	return "riga " + std::to_string(line) + ": " + what;
+}
+
+bool parse_number(const std::string & token, uint32_t & value)
+{
+	if (token.empty() || token[0] < '0' || token[0] > '9')
+		return false;
+
+	char * end = nullptr;
+	errno = 0;
+	unsigned long v = std::strtoul(token.c_str(), &end, 10);
+	if (*end != '\0' || errno != 0 || v > UINT32_MAX)
+		return false;
+	value = static_cast<uint32_t>(v);
+	return true;
+}
+
+}
+
+schedule_file::schedule_file(const std::string & path)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw schedule_error("impossibile aprire " + path + ": " + std::strerror(errno));
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		throw schedule_error("file vuoto o illeggibile: " + path);
+	}
+
+	// pagine caricate subito (MAP_POPULATE): nessun page fault quando l'executive è già partito
+	mapping_size = st.st_size;
+	mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		mapping = nullptr;
+		throw schedule_error("mmap di " + path + " fallita: " + std::strerror(errno));
+	}
+
+	if (mapping_size >= sizeof(uint32_t) && *static_cast<const uint32_t *>(mapping) == magic)
+	{
+		// forma binaria: si usa direttamente la memoria mappata
+		if (mapping_size % sizeof(uint32_t) != 0)
+		{
+			munmap(mapping, mapping_size);
+			throw schedule_error(path + ": dimensione non valida per la forma binaria");
+		}
+		data = static_cast<const uint32_t *>(mapping);
+		size = mapping_size / sizeof(uint32_t);
+	}
+	else
+	{
+		// forma testuale: viene tradotta nella forma binaria, in memoria
+		try {
+			parse_text(static_cast<const char *>(mapping), mapping_size);
+		} catch (const schedule_error & e) {
+			munmap(mapping, mapping_size);
+			throw schedule_error(path + ", " + e.what());
+		}
+		munmap(mapping, mapping_size);
+		mapping = nullptr;
+		data = image.data();
+		size = image.size();
+	}
+
+	try {
+		check();
+	} catch (const schedule_error & e) {
+		if (mapping)
+			munmap(mapping, mapping_size);
+		throw schedule_error(path + ": " + e.what());
+	}
+}
+
+schedule_file::~schedule_file()
+{
+	if (mapping)
+		munmap(mapping, mapping_size);
+}
+
+void schedule_file::parse_text(const char * text, size_t text_size)
+{
+	uint32_t frame_length = 0, unit_duration = 0;
+	std::vector<task_record> tasks;
+	std::map<std::string, uint32_t> ids;
+	std::vector<uint32_t> frame_begin(1, 0), table;
+	std::string names;
+
+	std::istringstream in(std::string(text, text_size));
+	std::string line;
+	for (size_t n = 1; std::getline(in, line); ++n)
+	{
+		line = line.substr(0, line.find('#'));
+		std::istringstream words(line);
+		std::vector<std::string> tokens;
+		for (std::string token; words >> token; )
+			tokens.push_back(token);
+		if (tokens.empty())
+			continue;
+
+		const std::string & directive = tokens[0];
+		if (directive == "frame_length" || directive == "unit_duration")
+		{
+			uint32_t & value = directive == "frame_length" ? frame_length : unit_duration;
+			if (tokens.size() != 2 || !parse_number(tokens[1], value) || value == 0)
+				throw schedule_error(error_at(n, "atteso \"" + directive + " <intero positivo>\""));
+		}
+		else if (directive == "task")
+		{
+			uint32_t wcet = 0;
+			if (tokens.size() != 3 || !parse_number(tokens[2], wcet))
+				throw schedule_error(error_at(n, "atteso \"task <nome> <wcet>\""));
+			if (!ids.insert(std::make_pair(tokens[1], static_cast<uint32_t>(tasks.size()))).second)
+				throw schedule_error(error_at(n, "task \"" + tokens[1] + "\" già dichiarato"));
+
+			tasks.push_back(task_record{wcet, static_cast<uint32_t>(names.size())});
+			names += tokens[1];
+			names += '\0';
+		}
+		else if (directive == "frame")
+		{
+			for (size_t i = 1; i < tokens.size(); ++i)
+			{
+				uint32_t id = 0;
+				if (!parse_number(tokens[i], id))
+				{
+					auto it = ids.find(tokens[i]);
+					if (it == ids.end())
+						throw schedule_error(error_at(n, "task \"" + tokens[i] + "\" non dichiarato"));
+					id = it->second;
+				}
+				table.push_back(id);
+			}
+			frame_begin.push_back(table.size());
+		}
+		else
+			throw schedule_error(error_at(n, "direttiva \"" + directive + "\" sconosciuta"));
+	}
+
+	if (frame_length == 0 || unit_duration == 0)
+		throw schedule_error("frame_length o unit_duration mancante");
+	names.resize((names.size() + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t), '\0');
+
+	image.clear();
+	image.reserve(header_words + tasks.size() * task_words + frame_begin.size() + table.size() + names.size() / sizeof(uint32_t));
+	const uint32_t head[] = {magic, version, frame_length, unit_duration, static_cast<uint32_t>(tasks.size()),
+	                         static_cast<uint32_t>(frame_begin.size() - 1), static_cast<uint32_t>(table.size()),
+	                         static_cast<uint32_t>(names.size())};
+	image.insert(image.end(), head, head + header_words);
+	for (auto & t: tasks)
+	{
+		image.push_back(t.wcet);
+		image.push_back(t.name);
+	}
+	image.insert(image.end(), frame_begin.begin(), frame_begin.end());
+	image.insert(image.end(), table.begin(), table.end());
+	const size_t names_at = image.size();
+	image.resize(names_at + names.size() / sizeof(uint32_t));
+	if (!names.empty())
+		std::memcpy(&image[names_at], names.data(), names.size());
+}
+
+void schedule_file::check() const
+{
+	static_assert(sizeof(header) == header_words * sizeof(uint32_t), "schedule_file: intestazione");
+	static_assert(sizeof(task_record) == task_words * sizeof(uint32_t), "schedule_file: record dei task");
+
+	if (size < header_words)
+		throw schedule_error("intestazione troncata");
+
+	const header & h = *reinterpret_cast<const header *>(data);
+	if (h.magic != magic || h.version != version)
+		throw schedule_error("formato o versione non supportati");
+	if (h.frame_length == 0 || h.unit_duration == 0 || h.num_frames == 0)
+		throw schedule_error("frame_length, unit_duration e numero di frame devono essere positivi");
+	if (h.names_size % sizeof(uint32_t) != 0)
+		throw schedule_error("area dei nomi non allineata");
+
+	const uint64_t expected = header_words + uint64_t(h.num_tasks) * task_words + (uint64_t(h.num_frames) + 1) +
+	                          h.table_size + h.names_size / sizeof(uint32_t);
+	if (expected != size)
+		throw schedule_error("dimensione del file non coerente con l'intestazione");
+
+	const char * names = reinterpret_cast<const char *>(data + size) - h.names_size;
+	if (h.num_tasks > 0 && (h.names_size == 0 || names[h.names_size - 1] != '\0'))
+		throw schedule_error("nomi dei task non terminati");
+	for (size_t id = 0; id < h.num_tasks; ++id)
+		if (reinterpret_cast<const task_record *>(data + header_words)[id].name >= h.names_size)
+			throw schedule_error("nome del task " + std::to_string(id) + " fuori dall'area dei nomi");
+
+	const uint32_t * begin = offsets();
+	if (begin[0] != 0 || begin[h.num_frames] != h.table_size)
+		throw schedule_error("offset dei frame non validi");
+	for (size_t f = 0; f < h.num_frames; ++f)
+		if (begin[f] > begin[f + 1])
+			throw schedule_error("offset dei frame non crescenti");
+	for (const uint32_t * id = table(); id != table() + h.table_size; ++id)
+		if (*id >= h.num_tasks)
+			throw schedule_error("id di task " + std::to_string(*id) + " fuori dal task set");
+}
+
+unsigned int schedule_file::frame_length() const
+{
+	return reinterpret_cast<const header *>(data)->frame_length;
+}
+
+unsigned int schedule_file::unit_duration() const
+{
+	return reinterpret_cast<const header *>(data)->unit_duration;
+}
+
+size_t schedule_file::num_tasks() const
+{
+	return reinterpret_cast<const header *>(data)->num_tasks;
+}
+
+const char * schedule_file::task_name(size_t task_id) const
+{
+	const header & h = *reinterpret_cast<const header *>(data);
+	const char * names = reinterpret_cast<const char *>(data + size) - h.names_size;
+	return names + reinterpret_cast<const task_record *>(data + header_words)[task_id].name;
+}
+
+unsigned int schedule_file::task_wcet(size_t task_id) const
+{
+	return reinterpret_cast<const task_record *>(data + header_words)[task_id].wcet;
+}
+
+size_t schedule_file::num_frames() const
+{
+	return reinterpret_cast<const header *>(data)->num_frames;
+}
+
+const uint32_t * schedule_file::frame_begin(size_t f) const
+{
+	return table() + offsets()[f];
+}
+
+const uint32_t * schedule_file::frame_end(size_t f) const
+{
+	return table() + offsets()[f + 1];
+}
+
+const uint32_t * schedule_file::offsets() const
+{
+	return data + header_words + num_tasks() * task_words;
+}
+
+const uint32_t * schedule_file::table() const
+{
+	return offsets() + num_frames() + 1;
+}
+
+void schedule_file::apply(Executive & exec, const std::map< std::string, std::function<void()> > & functions) const
+{
+	for (size_t id = 0; id < num_tasks(); ++id)
+	{
+		auto it = functions.find(task_name(id));
+		if (it == functions.end())
+			throw schedule_error(std::string("nessuna funzione registrata per il task \"") + task_name(id) + "\"");
+		exec.set_periodic_task(id, it->second, task_wcet(id));
+	}
+
+	for (size_t f = 0; f < num_frames(); ++f)
+		exec.add_frame(std::vector<size_t>(frame_begin(f), frame_end(f)));
+}
+
+void schedule_file::save(const std::string & path) const
+{
+	FILE * out = std::fopen(path.c_str(), "wb");
+	if (!out)
+		throw schedule_error("impossibile scrivere " + path + ": " + std::strerror(errno));
+
+	const bool ok = std::fwrite(data, sizeof(uint32_t), size, out) == size;
+	if (std::fclose(out) != 0 || !ok)
+		throw schedule_error("scrittura di " + path + " fallita");
+}
@@ -0,0 +1,74 @@
+#ifndef SCHEDULE_FILE_H
+#define SCHEDULE_FILE_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "schedule.h"
+
+class Executive;
+
+/* Schedule letto da file, in forma testuale (per scriverlo a mano) o binaria (per caricarlo in fretta).
+
+   Forma testuale, una direttiva per riga ('#' inizia un commento):
+	frame_length 4          lunghezza del frame, in quanti
+	unit_duration 400       durata del quanto, in ms
+	task task0 1            task periodico: nome e wcet (in quanti); l'id è l'ordine di dichiarazione
+	frame task0 task1 2     task di un frame, in ordine di esecuzione: per nome o per id
+
+   Forma binaria (prodotta da save() o da schedule_compile): intestazione, task, offset dei frame,
+   tabella piatta degli id e nomi, tutto a 32 bit nell'ordine dei byte della macchina. Il file viene
+   mappato in memoria (mmap) e usato così com'è: il caricamento verifica solo i limiti, senza parsing
+   nè allocazioni, anche con migliaia di frame.
+*/
+class schedule_file
+{
+	public:
+		/* Carica lo schedule dal file "path" (riconosce da solo la forma), throw schedule_error */
+		explicit schedule_file(const std::string & path);
+		~schedule_file();
+
+		schedule_file(const schedule_file &) = delete;
+		schedule_file & operator =(const schedule_file &) = delete;
+
+		unsigned int frame_length() const;
+		unsigned int unit_duration() const;
+
+		size_t num_tasks() const;
+		const char * task_name(size_t task_id) const;
+		unsigned int task_wcet(size_t task_id) const;
+
+		// il frame f è formato dagli id in [frame_begin(f), frame_end(f))
+		size_t num_frames() const;
+		const uint32_t * frame_begin(size_t f) const;
+		const uint32_t * frame_end(size_t f) const;
+
+		/* [INIT] Carica lo schedule in un executive costruito con
+		   Executive(num_tasks(), frame_length(), unit_duration(), ...):
+			functions: funzioni dei task, per nome (throw schedule_error se ne manca una).
+		*/
+		void apply(Executive & exec, const std::map< std::string, std::function<void()> > & functions) const;
+
+		/* Scrive lo schedule in forma binaria, throw schedule_error */
+		void save(const std::string & path) const;
+
+	private:
+		struct header;
+		struct task_record;
+
+		void parse_text(const char * text, size_t size);
+		void check() const;
+		const uint32_t * offsets() const;  // num_frames + 1 offset nella tabella
+		const uint32_t * table() const;
+
+		void * mapping = nullptr;   // file binario mappato
+		size_t mapping_size = 0;
+		std::vector<uint32_t> image;  // forma binaria costruita dal testo
+		const uint32_t * data = nullptr;
+		size_t size = 0;            // in parole da 32 bit
+};
+
+#endif
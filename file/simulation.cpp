@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "executive.h"
+#include "rt/priority.h"
+
+/* ------------------------------------------------------------------ */
+/*  Simulazione in tempo virtuale                                     */
+/* ------------------------------------------------------------------ */
+
+// thread di un task simulato: la parola di stato è quella vera del task (stesse transizioni dell'executive)
+struct Executive::sim_thread
+{
+	sim_thread(task_data * task, ap_task_data * ap) : task(task), ap(ap), prio(rt::priority::rt_min) {}
+
+	task_data * task;
+	ap_task_data * ap;         // != nullptr per i task aperiodici
+	rt::priority prio;
+	uint64_t seq = 0;          // ordine FIFO tra thread di pari priorità
+	int64_t remaining = -1;    // ns ancora da eseguire del job in corso, -1 = nessun job
+	int64_t job_release = 0;   // rilascio (o arrivo) del job in corso
+	uint64_t job_deadline = 0; // deadline (frame assoluto) del job aperiodico in corso
+	int64_t next_arrival = -1; // prossima richiesta (solo aperiodici con arrivi), -1 = nessuna
+};
+
+void Executive::set_sim_exec_time(size_t task_id, std::function<double()> exec_time)
+{
+	assert(task_id < p_tasks.size());
+	p_tasks[task_id].sim_exec_time = exec_time;
+}
+
+void Executive::set_sim_ap_exec_time(size_t ap_id, std::function<double()> exec_time)
+{
+	assert(ap_id < ap_tasks.size());
+	ap_tasks[ap_id]->sim_exec_time = exec_time;
+}
+
+void Executive::set_sim_ap_arrivals(size_t ap_id, std::function<double()> interarrival)
+{
+	assert(ap_id < ap_tasks.size());
+	ap_tasks[ap_id]->sim_interarrival = interarrival;
+}
+
+void Executive::simulate(uint64_t num_frames)
+{
+	// lo scheduler simulato è quello dei thread dei task sulla scala SCHED_FIFO
+	assert(!inline_dispatch && !use_deadline);
+	prepare();
+
+	const int64_t unit_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(unit_time).count();
+	const int64_t frame_ns = frame_length * unit_ns;
+	const rt::priority ap_top = ap_priority();
+	uint64_t seq = 0;
+
+	auto quanta_to_ns = [unit_ns](double q) { return std::max<int64_t>(0, std::llround(q * unit_ns)); };
+	auto exec_time = [&](const task_data & task) {
+		return quanta_to_ns(task.sim_exec_time ? task.sim_exec_time() : task.wcet);
+	};
+
+	for (size_t core = 0; core < cores.size(); ++core)
+	{
+		// la simulazione usa la sola modalità iniziale
+		const core_table & table = modes[0].cores[core];
+		const auto & tasks = table.tasks;
+		const auto & frame_begin = table.frame_begin;
+
+		// un thread per task del core (i task aperiodici stanno sul core 0)
+		std::vector<sim_thread> threads;
+		std::vector<size_t> thread_of(p_tasks.size());
+		for (size_t id = 0; id < p_tasks.size(); ++id)
+			if (p_tasks[id].core == core)
+			{
+				thread_of[id] = threads.size();
+				threads.push_back(sim_thread(&p_tasks[id], nullptr));
+			}
+		const size_t first_ap = threads.size();
+		if (core == 0)
+			for (auto & ap: ap_tasks)
+			{
+				threads.push_back(sim_thread(ap.get(), ap.get()));
+				if (ap->sim_interarrival)
+					threads.back().next_arrival = quanta_to_ns(ap->sim_interarrival());
+			}
+
+		auto set_prio = [&](sim_thread & th, rt::priority p) { th.prio = p; th.seq = ++seq; };
+		auto runnable = [](const sim_thread & th) {
+			return th.remaining >= 0 || get_state(*th.task) == TaskState::READY ||
+			       (th.ap && get_state(*th.task) == TaskState::RUNNING);
+		};
+
+		for (uint64_t frame_count = 0; frame_count < num_frames; ++frame_count)
+		{
+			const size_t frame_id = frame_count % table.slack.size();
+			const int64_t frame_start = frame_count * frame_ns;
+			const int64_t frame_end = frame_start + frame_ns;
+			const unsigned int slack = table.slack[frame_id];
+			int64_t boost_end = -1;
+
+			// 1-2) task aperiodici attivi, in ordine di deadline, sopra i periodici finchè c'è slack
+			if (core == 0 && !ap_tasks.empty())
+			{
+				ap_frame.store(frame_count, std::memory_order_relaxed);
+				ap_active.clear();
+				for (auto & ap: ap_tasks)
+				{
+					TaskState ap_state = get_state(*ap);
+					if (ap_state == TaskState::READY || ap_state == TaskState::RUNNING)
+						ap->sort_deadline = ap->deadline_frame.load(std::memory_order_relaxed);
+					else if (ap->queued.load(std::memory_order_relaxed) > 0)
+						ap->sort_deadline = frame_count + ap->deadline;
+					else
+						continue;
+
+					auto pos = ap_active.end();
+					while (pos != ap_active.begin() && (*(pos - 1))->sort_deadline > ap->sort_deadline)
+						--pos;
+					ap_active.insert(pos, ap.get());
+				}
+
+				const bool ap_boosted = slack > 0 && !ap_active.empty();
+				auto ap_prio = ap_top;
+				for (auto ap: ap_active)
+				{
+					set_prio(threads[first_ap + ap->id], ap_boosted ? ap_prio-- : rt::priority::rt_min);
+					if (!change_state(*ap, TaskState::IDLE, TaskState::READY))
+						change_state(*ap, TaskState::DONE, TaskState::READY);
+				}
+				if (ap_boosted && slack < frame_length)
+					boost_end = frame_start + slack * unit_ns;
+			}
+
+			// 3) rilascio dei periodici del frame, con le priorità precalcolate
+			for (size_t i = frame_begin[frame_id]; i < frame_begin[frame_id + 1]; ++i)
+			{
+				const size_t id = tasks[i];
+				task_data & task = p_tasks[id];
+				task.priority = table.priorities[i];
+				task.release_time.store(frame_start, std::memory_order_relaxed);
+
+				release_outcome outcome = release_periodic(task);
+				if (outcome == SKIPPED)
+					continue;
+				if (outcome == RELEASED)
+					set_prio(threads[thread_of[id]], task.priority);
+				task.released = true;
+			}
+
+			// esecuzione del frame: a ogni passo gira il thread pronto di priorità massima
+			int64_t now = frame_start;
+			while (now < frame_end)
+			{
+				int64_t next_event = frame_end;
+				if (boost_end > now)
+					next_event = std::min(next_event, boost_end);
+				for (size_t i = first_ap; i < threads.size(); ++i)
+					if (threads[i].next_arrival >= 0)
+						next_event = std::min(next_event, std::max(now, threads[i].next_arrival));
+
+				sim_thread * best = nullptr;
+				for (auto & th: threads)
+					if (runnable(th) && (!best || th.prio > best->prio || (th.prio == best->prio && th.seq < best->seq)))
+						best = &th;
+
+				if (best && best->remaining < 0)
+				{
+					// il thread prende un nuovo job (o, se aperiodico e senza richieste pronte, si sospende)
+					task_data & task = *best->task;
+					if (get_state(task) == TaskState::READY)
+						change_state(task, TaskState::READY, TaskState::RUNNING);
+
+					if (best->ap)
+					{
+						ap_task_data & ap = *best->ap;
+						ap_request req;
+						if (!ap.requests.front(req) || req.first_frame > frame_count)
+						{
+							change_state(ap, TaskState::RUNNING, TaskState::DONE);
+							continue;
+						}
+						ap.requests.pop(req);
+						ap.queued.fetch_sub(1, std::memory_order_relaxed);
+						ap.deadline_frame.store(req.deadline_frame, std::memory_order_relaxed);
+						best->job_release = req.arrival;
+						best->job_deadline = req.deadline_frame;
+					}
+					else
+					{
+						best->job_release = task.release_time.load(std::memory_order_relaxed);
+						task.cancelled.store(false, std::memory_order_relaxed);
+					}
+
+					task.release_jitter.record(now - best->job_release);
+					best->remaining = exec_time(task);
+				}
+
+				const int64_t step = best ? std::min(best->remaining, next_event - now) : next_event - now;
+				now += step;
+
+				if (best)
+				{
+					best->remaining -= step;
+					if (best->remaining == 0)
+					{
+						task_data & task = *best->task;
+						task.response_time.record(now - best->job_release);
+						best->remaining = -1;
+						if (best->ap)
+						{
+							best->ap->deadline_frame.store(UINT64_MAX, std::memory_order_relaxed);
+							if (frame_count >= best->job_deadline)
+								count_ap_miss(*best->ap, best->job_deadline);
+						}
+						else if (change_state(task, TaskState::RUNNING, TaskState::DONE))
+							task.degraded.store(false, std::memory_order_relaxed);
+						else if (change_state(task, TaskState::PENDING, TaskState::READY))
+							set_prio(*best, task.priority);  // il rilascio differito parte subito
+						else
+							change_state(task, TaskState::LATE, TaskState::DONE);
+					}
+				}
+
+				// 4) esaurito lo slack, i job aperiodici scendono sotto i periodici
+				if (now == boost_end)
+					for (auto ap: ap_active)
+					{
+						TaskState ap_state = get_state(*ap);
+						if (ap_state == TaskState::READY || ap_state == TaskState::RUNNING)
+							set_prio(threads[first_ap + ap->id], rt::priority::rt_min);
+					}
+
+				// richieste aperiodiche arrivate in questo istante
+				for (size_t i = first_ap; i < threads.size(); ++i)
+				{
+					sim_thread & th = threads[i];
+					while (th.next_arrival >= 0 && th.next_arrival <= now && now < frame_end)
+					{
+						admit_ap_request(*th.ap, th.next_arrival, frame_count);
+						th.next_arrival += std::max<int64_t>(1, quanta_to_ns(th.ap->sim_interarrival()));
+					}
+				}
+			}
+
+			// 6) deadline miss dei periodici del frame appena chiuso e dei job aperiodici scaduti
+			for (size_t i = frame_begin[frame_id]; i < frame_begin[frame_id + 1]; ++i)
+			{
+				const size_t id = tasks[i];
+				task_data & task = p_tasks[id];
+				if (!task.released)
+					continue;
+				task.released = false;
+
+				sim_thread & th = threads[thread_of[id]];
+				if (check_periodic_miss(task) != NOW_LATE)
+					continue;
+				set_prio(th, rt::priority::rt_min);
+				if (task.miss_policy == MissPolicy::ABORT)
+				{
+					// si assume che il job controlli job_cancelled() e termini subito
+					task.aborted.fetch_add(1, std::memory_order_relaxed);
+					th.remaining = -1;
+					change_state(task, TaskState::LATE, TaskState::DONE);
+				}
+			}
+
+			if (core == 0)
+				for (auto ap: ap_active)
+				{
+					uint64_t deadline = ap->deadline_frame.load(std::memory_order_relaxed);
+					if (get_state(*ap) == TaskState::RUNNING && frame_count + 1 >= deadline &&
+					    count_ap_miss(*ap, deadline))
+						set_prio(threads[first_ap + ap->id], rt::priority::rt_min);
+				}
+		}
+	}
+}
@@ -0,0 +1,219 @@
+#ifndef STATIC_SCHEDULE_H
+#define STATIC_SCHEDULE_H
+
+#include <cstddef>
+#include <vector>
+
+#include "executive.h"
+
+/* Schedule descritto a tempo di compilazione, alternativo a set_periodic_task / add_frame:
+
+	void task0();
+	void task1();
+
+	typedef static_schedule<4,                                     // frame_length (in quanti)
+	                        static_tasks< static_task<task0, 1>,    // task 0: funzione e wcet
+	                                      static_task<task1, 2> >,  // task 1
+	                        static_frame<0, 1>,                    // task di ogni frame, in ordine
+	                        static_frame<0> > schedule;
+
+	StaticExecutive<schedule> exec;  // unità di tempo e core come Executive
+	exec.start();
+
+   Gli id dei task e il carico di ogni frame (somma dei wcet <= frame_length) sono verificati con
+   static_assert, e i thread dei task invocano le funzioni direttamente, senza std::function. Per il
+   resto è uno schedule come gli altri: il costruttore passa la tabella ad add_frame e l'executive la
+   esegue dalle sue tabelle dei core. Politiche, task aperiodici, core e warm-up si impostano come per
+   Executive.
+*/
+
+namespace static_schedule_detail
+{
+
+template <size_t... Values> struct index_list {};
+
+constexpr bool all()
+{
+	return true;
+}
+
+template <typename... T>
+constexpr bool all(bool b, T... rest)
+{
+	return b && all(rest...);
+}
+
+constexpr unsigned int sum()
+{
+	return 0;
+}
+
+template <typename... T>
+constexpr unsigned int sum(unsigned int v, T... rest)
+{
+	return v + sum(rest...);
+}
+
+constexpr unsigned int nth(size_t)
+{
+	return 0;
+}
+
+template <typename... T>
+constexpr unsigned int nth(size_t i, unsigned int v, T... rest)
+{
+	return i == 0 ? v : nth(i - 1, rest...);
+}
+
+// concatenazione di liste
+template <typename... Lists> struct concat;
+
+template <size_t... A>
+struct concat< index_list<A...> >
+{
+	typedef index_list<A...> type;
+};
+
+template <size_t... A, size_t... B, typename... Rest>
+struct concat< index_list<A...>, index_list<B...>, Rest... >
+{
+	typedef typename concat< index_list<A..., B...>, Rest... >::type type;
+};
+
+// somme prefisse delle dimensioni: 0, s0, s0 + s1, ...
+template <typename List, size_t Sum, size_t... Sizes> struct prefix_sums;
+
+template <size_t... V, size_t Sum>
+struct prefix_sums< index_list<V...>, Sum >
+{
+	typedef index_list<V..., Sum> type;
+};
+
+template <size_t... V, size_t Sum, size_t Size, size_t... Rest>
+struct prefix_sums< index_list<V...>, Sum, Size, Rest... >
+{
+	typedef typename prefix_sums< index_list<V..., Sum>, Sum + Size, Rest... >::type type;
+};
+
+// array statico con i valori di una lista
+template <typename List> struct array;
+
+template <size_t... V>
+struct array< index_list<V...> >
+{
+	static constexpr size_t value[sizeof...(V)] = {V...};
+};
+
+template <size_t... V>
+constexpr size_t array< index_list<V...> >::value[sizeof...(V)];
+
+}
+
+/* Task periodico: funzione e wcet (in quanti temporali) */
+template <void (*Function)(), unsigned int Wcet>
+struct static_task
+{
+	static constexpr unsigned int wcet = Wcet;
+
+	static void install(Executive & exec, size_t task_id)
+	{
+		exec.set_periodic_task<Function>(task_id, Wcet);
+	}
+};
+
+/* Task set: l'id di ogni task è la sua posizione nella lista */
+template <typename... Tasks>
+struct static_tasks
+{
+	static constexpr size_t size = sizeof...(Tasks);
+
+	static constexpr unsigned int wcet(size_t task_id)
+	{
+		return static_schedule_detail::nth(task_id, Tasks::wcet...);
+	}
+
+	static void install(Executive & exec)
+	{
+		install_from<0, Tasks...>(exec);
+	}
+
+	private:
+		template <size_t Id>
+		static void install_from(Executive &)
+		{
+		}
+
+		template <size_t Id, typename Task, typename... Rest>
+		static void install_from(Executive & exec)
+		{
+			Task::install(exec, Id);
+			install_from<Id + 1, Rest...>(exec);
+		}
+};
+
+/* Frame: id dei task da eseguire, in sequenza */
+template <size_t... Ids>
+struct static_frame
+{
+	typedef static_schedule_detail::index_list<Ids...> ids;
+	static constexpr size_t size = sizeof...(Ids);
+
+	static constexpr bool valid(size_t num_tasks)
+	{
+		return static_schedule_detail::all((Ids < num_tasks)...);
+	}
+
+	template <typename Tasks>
+	static constexpr unsigned int load()
+	{
+		return static_schedule_detail::sum(Tasks::wcet(Ids)...);
+	}
+};
+
+/* Schedule: lunghezza del frame (in quanti), task set e tabella dei frame */
+template <unsigned int FrameLength, typename Tasks, typename... Frames>
+struct static_schedule
+{
+	static_assert(FrameLength > 0, "static_schedule: frame_length nullo");
+	static_assert(sizeof...(Frames) > 0, "static_schedule: nessun frame");
+	static_assert(static_schedule_detail::all(Frames::valid(Tasks::size)...),
+	              "static_schedule: id di task fuori dal task set");
+	static_assert(static_schedule_detail::all((Frames::template load<Tasks>() <= FrameLength)...),
+	              "static_schedule: la somma dei wcet di un frame supera frame_length");
+
+	typedef Tasks tasks;
+	static constexpr unsigned int frame_length = FrameLength;
+	static constexpr size_t num_tasks = Tasks::size;
+	static constexpr size_t num_frames = sizeof...(Frames);
+
+	// tabella piatta: il frame f è formato da table()[frame_begin()[f]] ... table()[frame_begin()[f + 1] - 1]
+	static const size_t * table()
+	{
+		return static_schedule_detail::array<
+			typename static_schedule_detail::concat<typename Frames::ids...>::type >::value;
+	}
+
+	static const size_t * frame_begin()
+	{
+		return static_schedule_detail::array<
+			typename static_schedule_detail::prefix_sums<static_schedule_detail::index_list<>, 0, Frames::size...>::type >::value;
+	}
+};
+
+/* Executive inizializzato da uno static_schedule */
+template <typename Schedule>
+class StaticExecutive : public Executive
+{
+	public:
+		/* [INIT] Carica task e frame di "Schedule" (unit_duration e num_cores come per Executive) */
+		explicit StaticExecutive(unsigned int unit_duration = 10, unsigned int num_cores = 1)
+			: Executive(Schedule::num_tasks, Schedule::frame_length, unit_duration, num_cores)
+		{
+			Schedule::tasks::install(*this);
+			for (size_t f = 0; f < Schedule::num_frames; ++f)
+				add_frame(std::vector<size_t>(Schedule::table() + Schedule::frame_begin()[f],
+				                              Schedule::table() + Schedule::frame_begin()[f + 1]));
+		}
+};
+
+#endif
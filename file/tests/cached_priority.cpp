@@ -0,0 +1,62 @@
+/* rt::cached_priority: get() dopo set(deadline_params) e dopo il ritorno alla scala FIFO.
+   SCHED_DEADLINE richiede i privilegi real-time: senza, il test viene saltato (uscita 0). */
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "../rt/priority.h"
+#include "../rt/deadline.h"
+
+int main()
+{
+	std::atomic<rt::tid_t> tid{0};
+	std::atomic<bool> done{false};
+	std::thread th([&]() {
+		tid.store(rt::this_thread::tid());
+		while (!done.load())
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	});
+	while (tid.load() == 0)
+		std::this_thread::yield();
+
+	rt::cached_priority prio;
+	prio.bind(th);
+	prio.bind_tid(tid.load());
+
+	rt::deadline_params params;
+	params.runtime = std::chrono::microseconds(100);
+	params.deadline = std::chrono::milliseconds(1);
+	params.period = std::chrono::milliseconds(10);
+	bool changed = false;
+	try {
+		changed = prio.set(params);
+	}
+	catch (const rt::permission_error& e) {
+		std::cout << "cached_priority: SCHED_DEADLINE non permesso (" << e.what() << "), test saltato" << std::endl;
+		done.store(true);
+		th.join();
+		return 0;
+	}
+
+	assert(changed);
+
+	// sotto SCHED_DEADLINE non c'è una priorità della scala FIFO
+	assert(prio.get() == rt::priority::not_rt);
+	changed = prio.set(params);
+	assert(!changed);
+	assert(prio.get() == rt::priority::not_rt);
+
+	// ritorno alla scala FIFO: get() torna a riportare la priorità impostata
+	changed = prio.set(rt::priority::rt_min);
+	assert(changed);
+	assert(prio.get() == rt::priority::rt_min);
+	assert(rt::get_priority(th) == rt::priority::rt_min);
+	(void)changed;  // letto solo dalle assert
+
+	done.store(true);
+	th.join();
+	std::cout << "cached_priority: ok" << std::endl;
+	return 0;
+}
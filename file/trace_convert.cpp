@@ -0,0 +1,188 @@
+#include "rt_trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+/* Converte una traccia binaria (rt_trace.h, Executive::set_trace) nel formato JSON Trace Event,
+   da aprire con chrome://tracing o https://ui.perfetto.dev:
+	trace_convert <traccia> <json> [primo frame [numero di frame]]
+   Un processo per core, con una riga per l'executive (i frame), una per ogni task periodico del core e,
+   sul core 0, una per ogni task aperiodico (i job); rilasci, deadline miss, cambi di priorità e richieste
+   aperiodiche sono eventi istantanei. Per vedere un iperperiodo: primo frame = k * frame della tabella,
+   numero di frame = frame della tabella.
+*/
+
+static const long long ap_tid = 1000000;  // tid dei task aperiodici: ap_tid + id
+
+// tid della riga di un task
+static long long tid_of(uint32_t id)
+{
+	return id & rttrace::ap_flag ? ap_tid + (id & ~rttrace::ap_flag) : 1 + static_cast<long long>(id);
+}
+
+int main(int argc, char ** argv)
+{
+	if (argc < 3 || argc > 5)
+	{
+		std::cerr << "uso: " << argv[0] << " <traccia> <json> [primo frame [numero di frame]]" << std::endl;
+		return 2;
+	}
+	const uint64_t first_frame = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 0;
+	const uint64_t num_frames = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : UINT64_MAX;
+
+	std::ifstream in(argv[1], std::ios::binary);
+	rttrace::file_header header;
+	if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+	    std::memcmp(header.magic, rttrace::magic, sizeof(header.magic)) != 0 ||
+	    header.version != rttrace::version || header.event_size != sizeof(rttrace::event))
+	{
+		std::cerr << "[ERROR] " << argv[1] << ": non è una traccia dell'executive (versione " << rttrace::version << ")" << std::endl;
+		return 1;
+	}
+
+	// nel file gli eventi sono raggruppati per thread: si riordinano per istante
+	std::vector<rttrace::event> events;
+	rttrace::event e;
+	while (in.read(reinterpret_cast<char *>(&e), sizeof(e)))
+		events.push_back(e);
+	std::stable_sort(events.begin(), events.end(), [](const rttrace::event & a, const rttrace::event & b) { return a.time < b.time; });
+
+	// core dei task e finestra [begin, end) dai frame del core 0
+	std::map<uint32_t, uint64_t> core_of;
+	int64_t begin = events.empty() ? 0 : events.front().time;
+	int64_t end = INT64_MAX;
+	for (auto & ev: events)
+	{
+		if (ev.type == rttrace::TASK_INFO)
+			core_of[ev.id] = ev.value;
+		else if (ev.type == rttrace::FRAME && ev.id == 0)
+		{
+			if (ev.value == first_frame)
+				begin = ev.time;
+			else if (num_frames != UINT64_MAX && ev.value == first_frame + num_frames)
+				end = ev.time;
+		}
+	}
+
+	FILE * out = std::fopen(argv[2], "w");
+	if (!out)
+	{
+		std::cerr << "[ERROR] Impossibile scrivere " << argv[2] << std::endl;
+		return 1;
+	}
+
+	const char * sep = "";
+	auto ts = [begin](int64_t t) { return (t - begin) / 1000.0; };
+	auto pid_of = [&core_of](uint32_t id) -> unsigned long long {
+		auto it = core_of.find(id);
+		return it == core_of.end() ? 0 : it->second;
+	};
+	auto task_name = [](uint32_t id, char * buf, size_t size) {
+		if (id & rttrace::ap_flag)
+			std::snprintf(buf, size, "AP %u", id & ~rttrace::ap_flag);
+		else
+			std::snprintf(buf, size, "task %u", id);
+		return buf;
+	};
+
+	std::fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	char name[32];
+	std::map<unsigned long long, bool> cores;
+	for (auto & info: core_of)
+	{
+		cores[info.second] = true;
+		std::fprintf(out, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%llu,\"tid\":%lld,\"args\":{\"name\":\"%s\"}}",
+		             sep, static_cast<unsigned long long>(info.second), tid_of(info.first), task_name(info.first, name, sizeof(name)));
+		sep = ",\n";
+	}
+	for (auto & core: cores)
+	{
+		std::fprintf(out, "%s{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%llu,\"args\":{\"name\":\"core %llu\"}}", sep, core.first, core.first);
+		std::fprintf(out, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%llu,\"tid\":0,\"args\":{\"name\":\"executive\"}}", core.first);
+		sep = ",\n";
+	}
+
+	// frame e job: intervalli dall'evento di inizio a quello di fine
+	std::map<uint32_t, rttrace::event> frame_open, job_open;
+	uint64_t jobs = 0, misses = 0;
+	for (auto & ev: events)
+	{
+		// oltre la finestra servono solo i confini che chiudono gli ultimi frame
+		if (ev.time >= end && ev.type != rttrace::FRAME)
+			continue;
+		const bool visible = ev.time >= begin;
+		switch (ev.type)
+		{
+			case rttrace::FRAME:
+			{
+				auto open = frame_open.find(ev.id);
+				const bool printed = open != frame_open.end() && open->second.time >= begin;
+				if (printed)
+					std::fprintf(out, "%s{\"ph\":\"X\",\"name\":\"frame %llu\",\"pid\":%u,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+					             sep, static_cast<unsigned long long>(open->second.value), ev.id,
+					             ts(open->second.time), (ev.time - open->second.time) / 1000.0);
+				if (ev.time < end)
+					frame_open[ev.id] = ev;
+				else
+					frame_open.erase(ev.id);
+				if (!printed)
+					continue;
+				break;
+			}
+			case rttrace::START:
+				job_open[ev.id] = ev;
+				continue;
+			case rttrace::FINISH:
+			{
+				auto open = job_open.find(ev.id);
+				if (open == job_open.end())
+					continue;
+				const bool printed = open->second.time >= begin;
+				if (printed)
+				{
+					std::fprintf(out, "%s{\"ph\":\"X\",\"name\":\"%s\",\"pid\":%llu,\"tid\":%lld,\"ts\":%.3f,\"dur\":%.3f,"
+					             "\"args\":{\"release_jitter_ns\":%lld,\"aborted\":%s}}",
+					             sep, task_name(ev.id, name, sizeof(name)), pid_of(ev.id), tid_of(ev.id), ts(open->second.time),
+					             (ev.time - open->second.time) / 1000.0,
+					             static_cast<long long>(open->second.time - static_cast<int64_t>(open->second.value)),
+					             ev.value ? "true" : "false");
+					++jobs;
+				}
+				job_open.erase(open);
+				if (!printed)
+					continue;
+				break;
+			}
+			case rttrace::RELEASE:
+			case rttrace::MISS:
+			case rttrace::PRIORITY:
+				if (!visible)
+					continue;
+				std::fprintf(out, "%s{\"ph\":\"i\",\"s\":\"t\",\"name\":\"%s\",\"pid\":%llu,\"tid\":%lld,\"ts\":%.3f,\"args\":{\"%s\":%llu}}",
+				             sep, ev.type == rttrace::RELEASE ? "release" : ev.type == rttrace::MISS ? "deadline miss" : "priority",
+				             pid_of(ev.id), tid_of(ev.id), ts(ev.time), ev.type == rttrace::PRIORITY ? "priority" : "frame",
+				             static_cast<unsigned long long>(ev.value));
+				misses += ev.type == rttrace::MISS;
+				break;
+			case rttrace::AP_REQUEST:
+				if (!visible)
+					continue;
+				std::fprintf(out, "%s{\"ph\":\"i\",\"s\":\"t\",\"name\":\"request %s\",\"pid\":0,\"tid\":%lld,\"ts\":%.3f}",
+				             sep, ev.value ? "accepted" : "rejected", tid_of(ev.id | rttrace::ap_flag), ts(ev.time));
+				break;
+			default:
+				continue;
+		}
+		sep = ",\n";
+	}
+	std::fprintf(out, "\n]}\n");
+	std::fclose(out);
+
+	std::cout << argv[2] << ": " << events.size() << " eventi, " << jobs << " job, " << misses << " deadline miss" << std::endl;
+	return 0;
+}